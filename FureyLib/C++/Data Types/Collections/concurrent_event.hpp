@@ -0,0 +1,317 @@
+// .hpp
+// Thread-Safe Multicast Event Type
+// by Kyle Furey
+
+#pragma once
+#include "event.hpp"
+#include "../Utilities/epoch.hpp"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include <type_traits>
+#include <cstdint>
+
+
+// CONCURRENT EVENT
+
+/**
+ * A multicast event that any thread can invoke while other threads bind and unbind functions.<br/>
+ * Invoking reads an immutable array of bound functions through an atomic pointer without locking, so its cost does not
+ * depend on contention. Binding and unbinding copy the array under a writer lock and publish the copy. Replaced arrays are
+ * reclaimed once no invoke can still see them (see epoch). Bound functions may be called from several threads at once.
+ */
+template <typename T, typename... A>
+class concurrent_event final {
+    static_assert((... && (std::is_lvalue_reference_v<A> || (!std::is_reference_v<A> && std::is_copy_constructible_v<A>))),
+                  "ERROR: An event cannot pass a move-only or rvalue reference argument to each bound function, so take it by lvalue reference!");
+
+public:
+
+    // TYPES
+
+    /** The type of function bound to this event. Functions up to EVENT_DELEGATE_SIZE bytes are stored without allocating. */
+    using target = delegate<T(A...)>;
+
+    /** The type of ID that identifies a bound function. */
+    using id_type = uintptr_t;
+
+
+    // CONNECTION
+
+    /** A handle to one bound function. Each binding's connection is unique for the lifetime of the event. */
+    class connection final {
+        friend class concurrent_event;
+
+        // DATA
+
+        /** The serial number of the binding, or 0. */
+        uint64_t serial;
+
+
+        // CONSTRUCTOR
+
+        /** Constructs a connection to the given binding. */
+        explicit connection(const uint64_t serial) noexcept : serial(serial) {
+        }
+
+    public:
+
+        // CONSTRUCTOR
+
+        /** Default constructor. Connects to nothing. */
+        connection() noexcept : serial(0) {
+        }
+
+
+        // OPERATORS
+
+        /** Returns whether both connections refer to the same binding. */
+        bool operator==(const connection &other) const noexcept {
+            return serial == other.serial;
+        }
+
+        /** Returns whether the connections refer to different bindings. */
+        bool operator!=(const connection &other) const noexcept {
+            return serial != other.serial;
+        }
+    };
+
+private:
+
+    // BINDING
+
+    /** A bound function, its ID, and its serial number. */
+    struct binding final {
+
+        // DATA
+
+        /** The ID of the function. */
+        id_type id;
+
+        /** The serial number of the binding. */
+        uint64_t serial;
+
+        /** The function. */
+        target callback;
+    };
+
+    /** An immutable array of bound functions. */
+    using listeners = std::vector<binding>;
+
+
+    // DATA
+
+    /** The current bound functions. */
+    std::atomic<const listeners *> current;
+
+    /** Serializes binding and unbinding. */
+    std::mutex writer;
+
+    /** The serial number of the next binding. */
+    uint64_t next_serial;
+
+    /** Each replaced array, waiting to be deleted. */
+    epoch::retired<listeners> retired;
+
+
+    // CONCURRENT EVENT
+
+    /** Creates an ID from the given function. */
+    static id_type make_id(const target &callback) {
+        if (callback.address() == 0) {
+            throw std::runtime_error("ERROR: Cannot implicitly generate an ID for a method or lambda!\n"
+                                     "Use make_id<T>() on an object to generate a ID for your function!");
+        }
+        return callback.address();
+    }
+
+    /** Replaces the current bound functions with the given array. Requires the writer lock. */
+    void publish(listeners &&next) {
+        retired.retire(current.exchange(new listeners(std::move(next))));
+    }
+
+    /** Unbinds the first bound function that matches the given predicate. */
+    template <typename F>
+    bool unbind_if(F &&predicate) {
+        std::lock_guard<std::mutex> guard(writer);
+        const listeners &bound = *current.load();
+        for (size_t i = 0; i < bound.size(); ++i) {
+            if (predicate(bound[i])) {
+                listeners next;
+                next.reserve(bound.size() - 1);
+                next.insert(next.end(), bound.begin(), bound.begin() + i);
+                next.insert(next.end(), bound.begin() + i + 1, bound.end());
+                publish(std::move(next));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /** Returns whether any bound function matches the given predicate. */
+    template <typename F>
+    bool any_of(F &&predicate) const {
+        const epoch::guard pin;
+        for (auto &bound : *current.load()) {
+            if (predicate(bound)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+
+    // CONSTRUCTORS AND DESTRUCTOR
+
+    /** Default constructor. */
+    concurrent_event() : current(new listeners()), writer(), next_serial(1), retired() {
+    }
+
+    /** Delete copy constructor. */
+    concurrent_event(const concurrent_event &) = delete;
+
+    /** Destructor. No thread may be invoking this event. */
+    ~concurrent_event() {
+        delete current.load();
+    }
+
+
+    // OPERATORS
+
+    /** Delete copy assignment operator. */
+    concurrent_event &operator=(const concurrent_event &) = delete;
+
+    /** Binds a new function to this event. */
+    concurrent_event &operator+=(const target &callback) {
+        bind(callback);
+        return *this;
+    }
+
+    /** Unbinds the first instance of the given function from this event. */
+    concurrent_event &operator-=(const target &callback) {
+        unbind(callback);
+        return *this;
+    }
+
+    /** Invokes each bound function with the given arguments and returns the most recent function's returned value. */
+    T operator()(event_parameter<A>... args) const {
+        return invoke(args...);
+    }
+
+
+    // CONCURRENT EVENT
+
+    /** Returns the total number of bound functions. */
+    size_t count() const {
+        const epoch::guard pin;
+        return current.load()->size();
+    }
+
+    /** Binds a new function pointer to this event and returns its connection. */
+    connection bind(const target &callback) {
+        return bind(make_id(callback), callback);
+    }
+
+    /** Binds a new function and its ID to this event and returns its connection. */
+    connection bind(const id_type id, target callback) {
+        if (callback == nullptr) {
+            throw std::runtime_error("ERROR: Cannot bind an invalid function to an event!");
+        }
+        std::lock_guard<std::mutex> guard(writer);
+        const listeners &bound = *current.load();
+        listeners next;
+        next.reserve(bound.size() + 1);
+        next.insert(next.end(), bound.begin(), bound.end());
+        const uint64_t serial = next_serial++;
+        next.push_back(binding{id, serial, std::move(callback)});
+        publish(std::move(next));
+        return connection(serial);
+    }
+
+    /** Unbinds the function of the given connection. Returns false if it was already unbound. */
+    bool unbind(const connection &bound) {
+        return bound.serial != 0 && unbind_if([&bound](const binding &other) {
+            return other.serial == bound.serial;
+        });
+    }
+
+    /** Unbinds the first bound function that matches the given ID from this event. */
+    bool unbind(const id_type id) {
+        return unbind_if([id](const binding &other) {
+            return other.id == id;
+        });
+    }
+
+    /** Unbinds the first bound function that matches the given function pointer from this event. */
+    bool unbind(const target &callback) {
+        if (callback == nullptr) {
+            return false;
+        }
+        return unbind(make_id(callback));
+    }
+
+    /** Returns whether the function of the given connection is still bound. */
+    bool is_bound(const connection &bound) const {
+        return bound.serial != 0 && any_of([&bound](const binding &other) {
+            return other.serial == bound.serial;
+        });
+    }
+
+    /** Returns whether at least one bound function matches the given ID. */
+    bool is_bound(const id_type id) const {
+        return any_of([id](const binding &other) {
+            return other.id == id;
+        });
+    }
+
+    /** Returns whether at least one bound function matches the given function pointer. */
+    bool is_bound(const target &callback) const {
+        if (callback == nullptr) {
+            return false;
+        }
+        return is_bound(make_id(callback));
+    }
+
+    /**
+     * Invokes each function that was bound when the invoke began, in the order they were bound, and returns the most recent
+     * function's returned value. Never locks. Bound functions may bind and unbind; changes apply from the next invoke.
+     */
+    T invoke(event_parameter<A>... args) const {
+        const epoch::guard pin;
+        const listeners &bound = *current.load();
+        if constexpr (std::is_void_v<T>) {
+            for (auto &pair : bound) {
+                pair.callback(args...);
+            }
+        }
+        else {
+            T result = T();
+            for (auto &pair : bound) {
+                result = pair.callback(args...);
+            }
+            return result;
+        }
+    }
+
+    /** Unbinds all functions from this event. */
+    void clear() {
+        std::lock_guard<std::mutex> guard(writer);
+        publish(listeners());
+    }
+
+    /** Deletes every replaced array of functions, waiting for invokes that could still see them. Must not be called while invoking. */
+    void synchronize() {
+        std::unique_lock<std::mutex> guard(writer);
+        retired.reclaim();
+        while (retired.size() != 0) {
+            guard.unlock();
+            std::this_thread::yield();
+            guard.lock();
+            retired.reclaim();
+        }
+    }
+};
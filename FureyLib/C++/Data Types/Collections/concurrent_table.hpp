@@ -0,0 +1,157 @@
+// .hpp
+// Concurrent Read-Mostly Table Type
+// by Kyle Furey
+
+#pragma once
+#include "table.hpp"
+#include "../Utilities/epoch.hpp"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+
+// CONCURRENT TABLE
+
+/**
+ * A table that many threads can read without locking while a few threads rewrite it.<br/>
+ * Readers see an immutable snapshot through an atomic pointer. Writers copy the current snapshot (O(1), see table),
+ * modify the copy, and publish it. Replaced snapshots are reclaimed once no reader that could still see them is active (see epoch).
+ */
+class concurrent_table final {
+
+    // DATA
+
+    /** The current snapshot. */
+    std::atomic<const table *> current;
+
+    /** Serializes writers. */
+    std::mutex writer;
+
+    /** Each replaced snapshot, waiting to be deleted. */
+    epoch::retired<table> retired;
+
+
+    // CONCURRENT TABLE
+
+    /** Replaces the current snapshot with the given table and reclaims unreachable snapshots. Requires the writer lock. */
+    void publish(table &&next) {
+        retired.retire(current.exchange(new table(std::move(next))));
+    }
+
+public:
+
+    // SNAPSHOT
+
+    /** A read lock on the snapshot of a concurrent table that was current when it was taken. Never blocks writers. */
+    class snapshot final {
+        friend class concurrent_table;
+
+        // DATA
+
+        /** Keeps the snapshot alive. */
+        const epoch::guard pin;
+
+        /** The table being read. */
+        const table *data;
+
+
+        // CONSTRUCTOR
+
+        /** Enters a read of the given concurrent table. */
+        snapshot(const concurrent_table &owner) noexcept : pin(), data(owner.current.load()) {
+        }
+
+    public:
+
+        // CONSTRUCTORS
+
+        /** Delete copy constructor. */
+        snapshot(const snapshot &) = delete;
+
+
+        // OPERATORS
+
+        /** Delete copy assignment operator. */
+        snapshot &operator=(const snapshot &) = delete;
+
+        /** Returns the table being read. */
+        const table &operator*() const noexcept {
+            return *data;
+        }
+
+        /** Returns the table being read. */
+        const table *operator->() const noexcept {
+            return data;
+        }
+    };
+
+
+    // CONSTRUCTORS AND DESTRUCTOR
+
+    /** Constructs a concurrent table that starts with the given table. */
+    concurrent_table(table initial = table()) : current(new table(std::move(initial))), writer(), retired() {
+    }
+
+    /** Delete copy constructor. */
+    concurrent_table(const concurrent_table &) = delete;
+
+    /** Destructor. No thread may be reading this table. */
+    ~concurrent_table() {
+        delete current.load();
+    }
+
+
+    // OPERATORS
+
+    /** Delete copy assignment operator. */
+    concurrent_table &operator=(const concurrent_table &) = delete;
+
+
+    // CONCURRENT TABLE
+
+    /** Returns a read lock on the current snapshot. Snapshots must be destroyed on the thread that took them. */
+    snapshot read() const noexcept {
+        return snapshot(*this);
+    }
+
+    /** Calls the given function with the current snapshot and returns its result. */
+    template <typename F>
+    auto read(F &&function) const {
+        const snapshot locked(*this);
+        return function(*locked);
+    }
+
+    /** Returns a copy of the current snapshot. O(1) until the copy is modified. */
+    table load() const {
+        const snapshot locked(*this);
+        return *locked;
+    }
+
+    /** Replaces the current snapshot with the given table. */
+    void store(table next) {
+        std::lock_guard<std::mutex> guard(writer);
+        publish(std::move(next));
+    }
+
+    /** Calls the given function with a copy of the current snapshot, then publishes the copy. Writers are serialized. */
+    template <typename F>
+    void write(F &&function) {
+        std::lock_guard<std::mutex> guard(writer);
+        table next(*current.load());
+        function(next);
+        publish(std::move(next));
+    }
+
+    /** Deletes every retired snapshot, waiting for readers that could still see them. Must not be called while reading. */
+    void synchronize() {
+        std::unique_lock<std::mutex> guard(writer);
+        retired.reclaim();
+        while (retired.size() != 0) {
+            guard.unlock();
+            std::this_thread::yield();
+            guard.lock();
+            retired.reclaim();
+        }
+    }
+};
@@ -0,0 +1,118 @@
+// .cpp
+// Concurrent Table Benchmark
+// by Kyle Furey
+
+// Measures how many reads per second concurrent_table serves as reader threads are added while one writer keeps publishing.
+// Build with optimizations, such as: c++ -std=c++17 -O2 -pthread concurrent_table_benchmark.cpp
+
+#include "concurrent_table.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+/** The number of objects in the benchmarked table. */
+#define BENCHMARK_KEYS 1024
+
+/** The number of milliseconds each number of readers is measured for. */
+#define BENCHMARK_MILLISECONDS 500
+
+/** Stores the results of each reader so they are not optimized away. */
+static std::atomic<long long> benchmark_sink;
+
+
+// BENCHMARK
+
+/** The reads and writes completed by one measurement. */
+struct benchmark_result final {
+    /** The number of reads per second across every reader. */
+    double reads;
+
+    /** The number of snapshots the writer published per second. */
+    double writes;
+};
+
+/** Runs the given number of readers for BENCHMARK_MILLISECONDS while one writer rewrites an object of the table in a loop. */
+static benchmark_result benchmark_readers(concurrent_table &data, const std::vector<table::key> &keys, const size_t readers) {
+    std::atomic<bool> running(true);
+    std::atomic<size_t> ready(0);
+    std::vector<unsigned long long> reads(readers);
+    std::vector<std::thread> threads;
+    for (size_t reader = 0; reader < readers; ++reader) {
+        threads.emplace_back([&, reader]() {
+            unsigned long long count = 0;
+            long long sum = 0;
+            ready.fetch_add(1);
+            while (running.load(std::memory_order_relaxed)) {
+                const concurrent_table::snapshot locked = data.read();
+                sum += *locked->find<int>(keys[(count * 7 + reader) % keys.size()]);
+                ++count;
+            }
+            reads[reader] = count;
+            benchmark_sink.fetch_add(sum);
+        });
+    }
+    unsigned long long writes = 0;
+    std::thread writer([&]() {
+        while (running.load(std::memory_order_relaxed)) {
+            data.write([&](table &next) {
+                next.set<int>(keys[writes % keys.size()], static_cast<int>(writes));
+            });
+            ++writes;
+        }
+    });
+    while (ready.load() != readers) {
+        std::this_thread::yield();
+    }
+    const auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(BENCHMARK_MILLISECONDS));
+    running.store(false);
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    writer.join();
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    unsigned long long total = 0;
+    for (const unsigned long long count : reads) {
+        total += count;
+    }
+    data.synchronize();
+    return benchmark_result{total / elapsed, writes / elapsed};
+}
+
+
+// MAIN
+
+/** Entry point of the program. */
+int main() {
+    std::vector<std::string> names;
+    for (int i = 0; i < BENCHMARK_KEYS; ++i) {
+        names.push_back("key" + std::to_string(i));
+    }
+    std::vector<table::key> keys;
+    table initial;
+    for (const std::string &name : names) {
+        keys.emplace_back(name);
+        initial.set<int>(keys.back(), 0);
+    }
+    concurrent_table data(std::move(initial));
+
+    std::vector<size_t> counts = {1, 2, 4, 8};
+    const size_t cores = std::thread::hardware_concurrency();
+    if (cores > 8) {
+        counts.push_back(cores);
+    }
+
+    std::printf("concurrent_table, %d objects, one writer, %d ms per run\n\n", BENCHMARK_KEYS, BENCHMARK_MILLISECONDS);
+    double single = 0;
+    for (const size_t readers : counts) {
+        const benchmark_result result = benchmark_readers(data, keys, readers);
+        if (single == 0) {
+            single = result.reads;
+        }
+        std::printf("%3zu readers %14.0f reads/s %6.2fx %12.0f writes/s\n", readers, result.reads, result.reads / single, result.writes);
+    }
+    return 0;
+}
@@ -3,224 +3,700 @@
 // by Kyle Furey
 
 #pragma once
-#include <string>
+#include "../Utilities/worker_pool.hpp"
 #include <vector>
-#include <functional>
+#include <optional>
 #include <utility>
+#include <new>
 #include <stdexcept>
+#include <type_traits>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 
+/** The number of bytes a delegate stores inline before allocating its function on the heap. */
+#ifndef EVENT_DELEGATE_SIZE
+#define EVENT_DELEGATE_SIZE 32
+#endif
 
-// EVENT
 
-/** A collection of functions that can be bound, unbound, and invoked all at once. */
-template <typename T, typename... A>
-class event final {
-public:
+// PARAMETER
 
-    // TYPES
+/**
+ * The type delegates and events pass an argument of the given type as, so invoking never copies arguments itself.<br/>
+ * Scalars and references are passed as they are, copyable types by const reference, and move-only types by rvalue reference.
+ * Only delegates accept move-only and rvalue reference arguments, since an event passes the same arguments to each bound function.
+ */
+template <typename U>
+using event_parameter = std::conditional_t<std::is_scalar_v<U> || std::is_reference_v<U>, U,
+                                     std::conditional_t<std::is_copy_constructible_v<U>, const U &, U &&>>;
 
-    /** The type of function pointer bound to this event. */
-    using target = std::function<T(A...)>;
 
-private:
+// DELEGATE
+
+template <typename S, size_t SIZE = EVENT_DELEGATE_SIZE>
+class delegate;
+
+/**
+ * A copyable function wrapper that stores functions of up to SIZE bytes inline without allocating.<br/>
+ * Function pointers and small lambdas are copied with a single memcpy. Larger functions are stored on the heap.
+ */
+template <typename T, typename... A, size_t SIZE>
+class delegate<T(A...), SIZE> final {
+
+    // OPERATIONS
+
+    /** The operations a delegate performs on its stored function. */
+    enum class operation {
+        COPY,
+        MOVE,
+        DESTROY,
+    };
+
+    /** Implements the operations of functions of the given type. */
+    template <typename F>
+    struct handler final {
+
+        // CONSTANTS
+
+        /** Whether functions of this type are stored inline rather than on the heap. */
+        static constexpr bool INLINE = sizeof(F) <= SIZE && alignof(F) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<F>;
+
+        /** Whether functions of this type can be copied with memcpy and never need to be destroyed. */
+        static constexpr bool TRIVIAL = INLINE && std::is_trivially_copyable_v<F> && std::is_trivially_destructible_v<F>;
+
+
+        // HANDLER
+
+        /** Returns a pointer to the function in the given storage. */
+        static F *get(void *storage) noexcept {
+            if constexpr (INLINE) {
+                return std::launder(static_cast<F *>(storage));
+            }
+            else {
+                return *static_cast<F **>(storage);
+            }
+        }
+
+        /** Constructs a new function in the given storage. */
+        template <typename G>
+        static void construct(void *storage, G &&function) {
+            if constexpr (INLINE) {
+                new (storage) F(std::forward<G>(function));
+            }
+            else {
+                *static_cast<F **>(storage) = new F(std::forward<G>(function));
+            }
+        }
+
+        /** Calls the function in the given storage with the given arguments. */
+        static T call(void *storage, event_parameter<A>... args) {
+            return (*get(storage))(std::forward<event_parameter<A>>(args)...);
+        }
+
+        /** Copies, moves, or destroys the function in the given source storage. */
+        static void manage(const operation type, void *source, void *destination) {
+            switch (type) {
+                case operation::COPY:
+                    construct(destination, *get(source));
+                    break;
+                case operation::MOVE:
+                    if constexpr (INLINE) {
+                        new (destination) F(std::move(*get(source)));
+                        get(source)->~F();
+                    }
+                    else {
+                        *static_cast<F **>(destination) = *static_cast<F **>(source);
+                    }
+                    break;
+                case operation::DESTROY:
+                    if constexpr (INLINE) {
+                        get(source)->~F();
+                    }
+                    else {
+                        delete get(source);
+                    }
+                    break;
+            }
+        }
+    };
+
 
     // DATA
 
-    /** Each bound function and its ID. */
-    std::vector<std::pair<std::string, target>> bindings;
+    /** Calls the stored function, or nullptr if this delegate is empty. */
+    T (*invoker)(void *storage, event_parameter<A>... args);
 
+    /** Copies, moves, or destroys the stored function, or nullptr if it is trivial. */
+    void (*manager)(operation type, void *source, void *destination);
 
-    // EVENT
+    /** The address of the stored function if it is a function pointer, or 0. */
+    uintptr_t pointer;
 
-    /** Creates a string ID from the given function. */
-    static std::string make_id(const target &callback) {
-        if (callback.template target<T (*)(A...)>() == nullptr) {
-            throw std::runtime_error("ERROR: Cannot implicitly generate an ID for a method or lambda!\n"
-                                     "Use make_id<T>() on an object to generate a ID for your function!");
+    /** The inline storage of the function, or a pointer to it on the heap. */
+    alignas(std::max_align_t) mutable unsigned char storage[SIZE];
+
+
+    // DELEGATE
+
+    /** Destroys the stored function. */
+    void reset() noexcept {
+        if (manager != nullptr) {
+            manager(operation::DESTROY, storage, nullptr);
+        }
+        invoker = nullptr;
+        manager = nullptr;
+        pointer = 0;
+    }
+
+    /** Takes the function of the given delegate, leaving it empty. This delegate must be empty. */
+    void take(delegate &moved) noexcept {
+        if (moved.manager != nullptr) {
+            moved.manager(operation::MOVE, moved.storage, storage);
+        }
+        else {
+            std::memcpy(storage, moved.storage, SIZE);
         }
-        return std::to_string(reinterpret_cast<uintptr_t>(*callback.template target<T (*)(A...)>));
+        invoker = moved.invoker;
+        manager = moved.manager;
+        pointer = moved.pointer;
+        moved.invoker = nullptr;
+        moved.manager = nullptr;
+        moved.pointer = 0;
     }
 
 public:
 
-    // CONSTRUCTOR
+    // CONSTRUCTORS AND DESTRUCTOR
 
     /** Default constructor. */
-    explicit event(const size_t capacity = 8) : bindings() {
-        bindings.reserve(capacity);
+    delegate() noexcept : invoker(nullptr), manager(nullptr), pointer(0), storage() {
     }
 
+    /** Constructs an empty delegate. */
+    delegate(std::nullptr_t) noexcept : delegate() {
+    }
 
-    // OPERATORS
+    /** Constructs a delegate that calls the given function pointer. */
+    delegate(T (*function)(A...)) noexcept : delegate() {
+        if (function != nullptr) {
+            handler<T (*)(A...)>::construct(storage, function);
+            invoker = &handler<T (*)(A...)>::call;
+            pointer = reinterpret_cast<uintptr_t>(function);
+        }
+    }
 
-    /** Binds a new function to this event. */
-    event &operator+=(const target &callback) {
-        bind(callback);
-        return *this;
+    /** Constructs a delegate that calls the given function object. */
+    template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, delegate> &&
+                                                      !std::is_same_v<std::decay_t<F>, T (*)(A...)> &&
+                                                      std::is_invocable_r_v<T, std::decay_t<F> &, event_parameter<A>...>>>
+    delegate(F &&function) : delegate() {
+        using U = std::decay_t<F>;
+        handler<U>::construct(storage, std::forward<F>(function));
+        invoker = &handler<U>::call;
+        manager = handler<U>::TRIVIAL ? nullptr : &handler<U>::manage;
+        if constexpr (std::is_pointer_v<U> && std::is_function_v<std::remove_pointer_t<U>>) {
+            pointer = reinterpret_cast<uintptr_t>(*handler<U>::get(storage));
+            if (pointer == 0) {
+                invoker = nullptr;
+            }
+        }
     }
 
-    /** Unbinds the first instance of the given function from this event. */
-    event &operator-=(const target &callback) {
-        unbind(callback);
-        return *this;
+    /** Copy constructor. */
+    delegate(const delegate &copied) : invoker(nullptr), manager(nullptr), pointer(0), storage() {
+        if (copied.manager != nullptr) {
+            copied.manager(operation::COPY, copied.storage, storage);
+        }
+        else {
+            std::memcpy(storage, copied.storage, SIZE);
+        }
+        invoker = copied.invoker;
+        manager = copied.manager;
+        pointer = copied.pointer;
     }
 
-    /** Invokes each bound function with the given arguments and returns the most recent function's returned value. */
-    T operator()(A... args) {
-        return invoke(args...);
+    /** Move constructor. */
+    delegate(delegate &&moved) noexcept : invoker(nullptr), manager(nullptr), pointer(0), storage() {
+        take(moved);
     }
 
-    /** Invokes each bound function with the given arguments and returns the most recent function's returned value. */
-    T operator()(A... args) const {
-        return invoke(args...);
+    /** Destructor. */
+    ~delegate() {
+        reset();
     }
 
 
-    // EVENT
+    // OPERATORS
 
-    /** Returns an iterator to the beginning of the event. */
-    typename std::vector<std::pair<std::string, target>>::const_iterator begin() const {
-        return bindings.begin();
+    /** Copy assignment operator. */
+    delegate &operator=(const delegate &copied) {
+        if (this != &copied) {
+            delegate temp(copied);
+            reset();
+            take(temp);
+        }
+        return *this;
     }
 
-    /** Returns an iterator to the end of the event. */
-    typename std::vector<std::pair<std::string, target>>::const_iterator end() const {
-        return bindings.end();
+    /** Move assignment operator. */
+    delegate &operator=(delegate &&moved) noexcept {
+        if (this != &moved) {
+            reset();
+            take(moved);
+        }
+        return *this;
     }
 
-    /** Returns the total number of bound functions. */
-    size_t count() const {
-        return bindings.size();
+    /** Empties this delegate. */
+    delegate &operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
     }
 
-    /** Returns the maximum number of functions that can be bound before resizing. */
-    size_t capacity() const {
-        return bindings.capacity();
+    /** Calls the stored function with the given arguments without copying them. The delegate must not be empty. */
+    T operator()(event_parameter<A>... args) const {
+        return invoker(storage, std::forward<event_parameter<A>>(args)...);
     }
 
-    /** Binds a new function to this event. */
-    void bind(const target &callback) {
-        bind(make_id(callback), callback);
+    /** Returns whether this delegate stores a function. */
+    explicit operator bool() const noexcept {
+        return invoker != nullptr;
     }
 
-    /** Binds a new function and its ID to this event. */
-    void bind(const std::string &id, const target &callback) {
-        if (callback == nullptr) {
-            throw std::runtime_error("ERROR: Cannot bind an invalid function to an event!");
-        }
-        bindings.emplace_back(id, callback);
+    /** Returns whether the delegate is empty. */
+    friend bool operator==(const delegate &callback, std::nullptr_t) noexcept {
+        return callback.invoker == nullptr;
     }
 
-    /** Unbinds the first bound function that matches the given ID from this event. */
-    bool unbind(const std::string &id) {
-        const size_t size = bindings.size();
-        for (size_t i = 0; i < size; ++i) {
-            if (bindings[i].first == id) {
-                bindings.erase(bindings.begin() + i);
-                return true;
-            }
-        }
-        return false;
+    /** Returns whether the delegate stores a function. */
+    friend bool operator!=(const delegate &callback, std::nullptr_t) noexcept {
+        return callback.invoker != nullptr;
     }
 
-    /** Unbinds the first bound function that matches the given function from this event. */
-    bool unbind(const target &callback) {
-        if (callback == nullptr) {
-            return false;
-        }
-        return unbind(make_id(callback));
+
+    // DELEGATE
+
+    /** Returns the address of the stored function if it is a function pointer, or 0. */
+    uintptr_t address() const noexcept {
+        return pointer;
     }
+};
 
-    /** Returns whether at least one bound function matches the given function. */
-    bool is_bound(const target &callback) const {
-        if (callback == nullptr) {
-            return false;
+
+// EVENT
+
+/**
+ * A collection of functions that can be bound, unbound, and invoked all at once.<br/>
+ * Functions are always invoked in the order they were bound. Binding returns a connection that unbinds in O(1):
+ * unbound functions are left as tombstones and removed in one pass once they make up half of the bindings.<br/>
+ * Bound functions may bind, unbind, and clear while the event is being invoked. Unbound functions are not called again,
+ * and new functions are bound once the outermost invoke returns.
+ */
+template <typename T, typename... A>
+class event final {
+    static_assert((... && (std::is_lvalue_reference_v<A> || (!std::is_reference_v<A> && std::is_copy_constructible_v<A>))),
+                  "ERROR: An event cannot pass a move-only or rvalue reference argument to each bound function, so take it by lvalue reference!");
+
+public:
+
+    // TYPES
+
+    /** The type of function bound to this event. Functions up to EVENT_DELEGATE_SIZE bytes are stored without allocating. */
+    using target = delegate<T(A...)>;
+
+    /** The type of ID that identifies a bound function. */
+    using id_type = uintptr_t;
+
+
+    // CONNECTION
+
+    /** A handle to one bound function. Stays safe to use after the function is unbound, even if its slot is reused. */
+    class connection final {
+        friend class event;
+
+        // DATA
+
+        /** The index of the slot of the bound function. */
+        uint32_t index;
+
+        /** The generation of the slot when the function was bound. */
+        uint32_t generation;
+
+
+        // CONSTRUCTOR
+
+        /** Constructs a connection to the given slot. */
+        connection(const uint32_t index, const uint32_t generation) noexcept : index(index), generation(generation) {
         }
-        return is_bound(make_id(callback));
-    }
 
-    /** Returns whether at least one bound function matches the given ID. */
-    bool is_bound(const std::string &id) const {
-        for (auto &pair : bindings) {
-            if (pair.first == id) {
-                return true;
-            }
+    public:
+
+        // CONSTRUCTOR
+
+        /** Default constructor. Connects to nothing. */
+        connection() noexcept : index(NO_SLOT), generation(0) {
         }
-        return false;
-    }
 
-    /** Invokes each bound function with the given arguments and returns the most recent function's returned value. */
-    T invoke(A... args) {
-        T result = T();
-        for (auto &pair : bindings) {
-            if (pair.second == nullptr) {
-                throw std::runtime_error("ERROR: Attempted to invoke an invalid function in an event!");
-            }
-            result = pair.second(args...);
+
+        // OPERATORS
+
+        /** Returns whether both connections refer to the same binding. */
+        bool operator==(const connection &other) const noexcept {
+            return index == other.index && generation == other.generation;
         }
-        return result;
-    }
 
-    /** Invokes each bound function with the given arguments and returns the most recent function's returned value. */
-    T invoke(A... args) const {
-        T result = T();
-        for (auto &pair : bindings) {
-            if (pair.second == nullptr) {
-                throw std::runtime_error("ERROR: Attempted to invoke an invalid function in an event!");
+        /** Returns whether the connections refer to different bindings. */
+        bool operator!=(const connection &other) const noexcept {
+            return !(*this == other);
+        }
+    };
+
+
+    // BINDING
+
+    /** A bound function and its ID. */
+    struct binding final {
+        friend class event;
+
+        // DATA
+
+        /** The ID of the function. */
+        id_type first;
+
+        /** The function. */
+        target second;
+
+    private:
+
+        /** The index of the slot of this binding, or NO_SLOT if it was unbound. */
+        uint32_t slot;
+
+    public:
+
+        // CONSTRUCTOR
+
+        /** Constructs a new binding. */
+        binding(const id_type id, target &&callback, const uint32_t slot) : first(id), second(std::move(callback)), slot(slot) {
+        }
+    };
+
+
+    // ITERATOR
+
+    /** Iterates each bound function in the order they will be invoked. */
+    class const_iterator final {
+        friend class event;
+
+        // DATA
+
+        /** The current binding. */
+        const binding *current;
+
+        /** The end of the bindings. */
+        const binding *last;
+
+
+        // CONSTRUCTOR
+
+        /** Constructs an iterator at the first bound function at or after the given binding. */
+        const_iterator(const binding *current, const binding *last) : current(current), last(last) {
+            skip();
+        }
+
+        /** Advances this iterator past unbound functions. */
+        void skip() {
+            while (current != last && current->slot == NO_SLOT) {
+                ++current;
             }
-            result = pair.second(args...);
         }
-        return result;
-    }
 
-    /** Unbinds all functions from this event. */
-    void clear() {
-        bindings.clear();
-    }
-};
+    public:
 
-/** A collection of functions that can be bound, unbound, and invoked all at once. */
-template <typename... A>
-class event<void, A...> final {
-public:
+        // OPERATORS
 
-    // TYPES
+        /** Returns the current binding. */
+        const binding &operator*() const {
+            return *current;
+        }
 
-    /** The type of function pointer bound to this event. */
-    using target = std::function<void(A...)>;
+        /** Returns the current binding. */
+        const binding *operator->() const {
+            return current;
+        }
+
+        /** Advances to the next binding. */
+        const_iterator &operator++() {
+            ++current;
+            skip();
+            return *this;
+        }
+
+        /** Returns whether both iterators point to the same binding. */
+        bool operator==(const const_iterator &other) const {
+            return current == other.current;
+        }
+
+        /** Returns whether the iterators point to different bindings. */
+        bool operator!=(const const_iterator &other) const {
+            return current != other.current;
+        }
+    };
 
 private:
 
+    // CONSTANTS
+
+    /** The index of no slot. */
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+    /** Marks the position of a binding that is waiting to be bound after an invoke. */
+    static constexpr uint32_t PENDING = 0x80000000u;
+
+
+    // SLOT
+
+    /** Maps a connection to the position of its binding. Slots are reused, so their generation counts each reuse. */
+    struct slot final {
+
+        // DATA
+
+        /** The position of the binding in this slot, or the next free slot if this slot is free. */
+        uint32_t position;
+
+        /** The number of times this slot has been freed. */
+        uint32_t generation;
+    };
+
+
     // DATA
 
-    /** Each bound function and its ID. */
-    std::vector<std::pair<std::string, target>> bindings;
+    /** Each bound function and its ID in the order they were bound, including unbound tombstones. */
+    std::vector<binding> bindings;
+
+    /** Each function bound while this event was being invoked, in order. */
+    std::vector<binding> pending;
+
+    /** The slot of each connection. */
+    std::vector<slot> slots;
+
+    /** The first free slot, or NO_SLOT. */
+    uint32_t free_slot;
+
+    /** The number of bound functions, including pending functions. */
+    size_t live;
+
+    /** The number of bindings that are unbound tombstones. */
+    size_t dead;
+
+    /** The number of tombstones unbound during an invoke whose functions have not been destroyed yet. */
+    size_t doomed;
+
+    /** The number of invokes in progress. */
+    size_t depth;
 
 
     // EVENT
 
-    /** Creates a string ID from the given function. */
-    static std::string make_id(const target &callback) {
-        if (callback.template target<void (*)(A...)>() == nullptr){
+    /** Creates an ID from the given function. */
+    static id_type make_id(const target &callback) {
+        if (callback.address() == 0) {
             throw std::runtime_error("ERROR: Cannot implicitly generate an ID for a method or lambda!\n"
                                      "Use make_id<T>() on an object to generate a ID for your function!");
         }
-        return std::to_string(reinterpret_cast<uintptr_t>(*callback.template target<void (*)(A...)>()));
+        return callback.address();
+    }
+
+    /** Frees the given slot, disconnecting its connections. */
+    void free_slot_at(const uint32_t index) noexcept {
+        slots[index].generation++;
+        slots[index].position = free_slot;
+        free_slot = index;
+    }
+
+    /** Returns the slot of a new binding at the given position. */
+    uint32_t claim_slot(const size_t position) {
+        if (free_slot != NO_SLOT) {
+            const uint32_t index = free_slot;
+            free_slot = slots[index].position;
+            slots[index].position = static_cast<uint32_t>(position);
+            return index;
+        }
+        if (slots.size() >= NO_SLOT) {
+            throw std::runtime_error("ERROR: Too many functions are bound to an event!");
+        }
+        slots.push_back(slot{static_cast<uint32_t>(position), 0});
+        return static_cast<uint32_t>(slots.size() - 1);
+    }
+
+    /** Leaves a tombstone at the given position and frees its slot. Functions are only destroyed outside of invokes. */
+    void unbind_at(const uint32_t position) {
+        --live;
+        if ((position & PENDING) != 0) {
+            binding &bound = pending[position & ~PENDING];
+            free_slot_at(bound.slot);
+            bound.slot = NO_SLOT;
+            bound.second = nullptr;
+            return;
+        }
+        binding &bound = bindings[position];
+        free_slot_at(bound.slot);
+        bound.slot = NO_SLOT;
+        ++dead;
+        if (depth == 0) {
+            bound.second = nullptr;
+            if (dead * 2 > bindings.size()) {
+                compact();
+            }
+        }
+        else {
+            ++doomed;
+        }
+    }
+
+    /** Removes every tombstone, keeping the bound functions in order. Must not be called during an invoke. */
+    void compact() {
+        size_t kept = 0;
+        for (size_t i = 0; i < bindings.size(); ++i) {
+            if (bindings[i].slot != NO_SLOT) {
+                if (kept != i) {
+                    bindings[kept] = std::move(bindings[i]);
+                }
+                slots[bindings[kept].slot].position = static_cast<uint32_t>(kept);
+                ++kept;
+            }
+        }
+        bindings.erase(bindings.begin() + kept, bindings.end());
+        dead = 0;
+        doomed = 0;
+    }
+
+    /**
+     * Applies the unbinds and binds deferred by the outermost invoke. Never throws, so it is safe to call while unwinding:
+     * if there is no memory to append the deferred binds, they stay deferred until another invoke returns.
+     */
+    void flush() noexcept {
+        if (dead * 2 > bindings.size()) {
+            compact();
+        }
+        else if (doomed != 0) {
+            for (auto &bound : bindings) {
+                if (bound.slot == NO_SLOT) {
+                    bound.second = nullptr;
+                }
+            }
+            doomed = 0;
+        }
+        if (pending.empty()) {
+            return;
+        }
+        try {
+            bindings.reserve(bindings.size() + pending.size());
+        }
+        catch (...) {
+            return;
+        }
+        for (auto &bound : pending) {
+            if (bound.slot != NO_SLOT) {
+                slots[bound.slot].position = static_cast<uint32_t>(bindings.size());
+                bindings.push_back(std::move(bound));
+            }
+        }
+        pending.clear();
+    }
+
+    /** Empties this event after it was moved. */
+    void reset() noexcept {
+        bindings.clear();
+        pending.clear();
+        slots.clear();
+        free_slot = NO_SLOT;
+        live = 0;
+        dead = 0;
+        doomed = 0;
     }
 
+    /** Returns the number of chunks to split the given number of bindings into across the given thread pool. */
+    static size_t chunk_count(const worker_pool &pool, const size_t size) noexcept {
+        const size_t chunks = pool.size() * 4;
+        return size < chunks ? size : chunks;
+    }
+
+    /** Tracks an invoke in progress and applies deferred modifications when the outermost invoke returns or throws. */
+    struct invocation final {
+
+        // DATA
+
+        /** The event being invoked. */
+        event &owner;
+
+
+        // CONSTRUCTOR AND DESTRUCTOR
+
+        /** Enters an invoke. */
+        invocation(event &owner) noexcept : owner(owner) {
+            ++owner.depth;
+        }
+
+        /** Exits an invoke. */
+        ~invocation() noexcept {
+            if (--owner.depth == 0 && (owner.doomed != 0 || !owner.pending.empty())) {
+                owner.flush();
+            }
+        }
+    };
+
 public:
 
     // CONSTRUCTOR
 
     /** Default constructor. */
-    explicit event(const size_t capacity = 8) : bindings() {
+    explicit event(const size_t capacity = 8) : bindings(), pending(), slots(), free_slot(NO_SLOT), live(0), dead(0), doomed(0), depth(0) {
         bindings.reserve(capacity);
+        slots.reserve(capacity);
     }
 
+    /** Copy constructor. A copy made during an invoke is not being invoked, so it applies the copied event's deferred binds. */
+    event(const event &copied) : bindings(copied.bindings), pending(copied.pending), slots(copied.slots), free_slot(copied.free_slot), live(copied.live), dead(copied.dead), doomed(copied.doomed), depth(0) {
+        bindings.reserve(bindings.size() + pending.size());
+        flush();
+    }
+
+    /** Move constructor. */
+    event(event &&moved) noexcept : bindings(std::move(moved.bindings)), pending(std::move(moved.pending)), slots(std::move(moved.slots)), free_slot(moved.free_slot), live(moved.live), dead(moved.dead), doomed(moved.doomed), depth(0) {
+        moved.reset();
+    }
+
+    /** Destructor. */
+    ~event() = default;
+
 
     // OPERATORS
 
+    /** Copy assignment operator. An event cannot be assigned to while it is being invoked. */
+    event &operator=(const event &copied) {
+        if (this != &copied) {
+            *this = event(copied);
+        }
+        return *this;
+    }
+
+    /** Move assignment operator. An event cannot be assigned to while it is being invoked. */
+    event &operator=(event &&moved) {
+        if (depth != 0) {
+            throw std::runtime_error("ERROR: Cannot assign to an event while it is being invoked!");
+        }
+        bindings = std::move(moved.bindings);
+        pending = std::move(moved.pending);
+        slots = std::move(moved.slots);
+        free_slot = moved.free_slot;
+        live = moved.live;
+        dead = moved.dead;
+        doomed = moved.doomed;
+        moved.reset();
+        return *this;
+    }
+
     /** Binds a new function to this event. */
     event &operator+=(const target &callback) {
         bind(callback);
@@ -233,31 +709,32 @@ public:
         return *this;
     }
 
-    /** Invokes each bound function with the given arguments. */
-    void operator()(A... args) {
-        invoke(args...);
+    /** Invokes each bound function with the given arguments and returns the most recent function's returned value. */
+    T operator()(event_parameter<A>... args) {
+        return invoke(args...);
     }
 
-    /** Invokes each bound function with the given arguments. */
-    void operator()(A... args) const {
-        invoke(args...);
-    }
 
     // EVENT
 
     /** Returns an iterator to the beginning of the event. */
-    typename std::vector<std::pair<std::string, target>>::const_iterator begin() const {
-        return bindings.begin();
+    const_iterator begin() const {
+        return const_iterator(bindings.data(), bindings.data() + bindings.size());
     }
 
     /** Returns an iterator to the end of the event. */
-    typename std::vector<std::pair<std::string, target>>::const_iterator end() const {
-        return bindings.end();
+    const_iterator end() const {
+        return const_iterator(bindings.data() + bindings.size(), bindings.data() + bindings.size());
     }
 
     /** Returns the total number of bound functions. */
     size_t count() const {
-        return bindings.size();
+        return live;
+    }
+
+    /** Returns whether this event is currently being invoked. */
+    bool is_invoking() const {
+        return depth != 0;
     }
 
     /** Returns the maximum number of functions that can be bound before resizing. */
@@ -265,32 +742,59 @@ public:
         return bindings.capacity();
     }
 
-    /** Binds a new function to this event. */
-    void bind(const target &callback) {
-        bind(make_id(callback), callback);
+    /** Binds a new function pointer to this event and returns its connection. */
+    connection bind(const target &callback) {
+        return bind(make_id(callback), callback);
     }
 
-    /** Binds a new function and its ID to this event. */
-    void bind(const std::string &id, const target &callback) {
+    /** Binds a new function and its ID to this event and returns its connection. Functions bound during an invoke are first called by the next invoke. */
+    connection bind(const id_type id, target callback) {
         if (callback == nullptr) {
             throw std::runtime_error("ERROR: Cannot bind an invalid function to an event!");
         }
-        bindings.emplace_back(id, callback);
+        std::vector<binding> &list = depth == 0 ? bindings : pending;
+        if (list.size() >= PENDING) {
+            throw std::runtime_error("ERROR: Too many functions are bound to an event!");
+        }
+        const uint32_t index = claim_slot(depth == 0 ? list.size() : (list.size() | PENDING));
+        try {
+            list.emplace_back(id, std::move(callback), index);
+        }
+        catch (...) {
+            free_slot_at(index);
+            throw;
+        }
+        ++live;
+        return connection(index, slots[index].generation);
+    }
+
+    /** Unbinds the function of the given connection in O(1). Returns false if it was already unbound. */
+    bool unbind(const connection &bound) {
+        if (!is_bound(bound)) {
+            return false;
+        }
+        unbind_at(slots[bound.index].position);
+        return true;
     }
 
     /** Unbinds the first bound function that matches the given ID from this event. */
-    bool unbind(const std::string &id) {
-        const size_t size = bindings.size();
-        for (size_t i = 0; i < size; ++i) {
-            if (bindings[i].first == id) {
-                bindings.erase(bindings.begin() + i);
+    bool unbind(const id_type id) {
+        for (size_t i = 0; i < bindings.size(); ++i) {
+            if (bindings[i].first == id && bindings[i].slot != NO_SLOT) {
+                unbind_at(static_cast<uint32_t>(i));
+                return true;
+            }
+        }
+        for (size_t i = 0; i < pending.size(); ++i) {
+            if (pending[i].first == id && pending[i].slot != NO_SLOT) {
+                unbind_at(static_cast<uint32_t>(i) | PENDING);
                 return true;
             }
         }
         return false;
     }
 
-    /** Unbinds the first bound function that matches the given function from this event. */
+    /** Unbinds the first bound function that matches the given function pointer from this event. */
     bool unbind(const target &callback) {
         if (callback == nullptr) {
             return false;
@@ -298,17 +802,27 @@ public:
         return unbind(make_id(callback));
     }
 
+    /** Returns whether the function of the given connection is still bound. */
+    bool is_bound(const connection &bound) const noexcept {
+        return bound.index < slots.size() && slots[bound.index].generation == bound.generation;
+    }
+
     /** Returns whether at least one bound function matches the given ID. */
-    bool is_bound(const std::string &id) const {
-        for (auto &pair : bindings) {
-            if (pair.first == id) {
+    bool is_bound(const id_type id) const {
+        for (auto &bound : *this) {
+            if (bound.first == id) {
+                return true;
+            }
+        }
+        for (auto &bound : pending) {
+            if (bound.first == id && bound.slot != NO_SLOT) {
                 return true;
             }
         }
         return false;
     }
 
-    /** Returns whether at least one bound function matches the given function. */
+    /** Returns whether at least one bound function matches the given function pointer. */
     bool is_bound(const target &callback) const {
         if (callback == nullptr) {
             return false;
@@ -316,38 +830,122 @@ public:
         return is_bound(make_id(callback));
     }
 
-    /** Invokes each bound function with the given arguments and returns the most recent function's returned value. */
-    void invoke(A... args) {
-        for (auto &pair : bindings) {
-            if (pair.second == nullptr) {
-                throw std::runtime_error("ERROR: Attempted to invoke an invalid function in an event!");
+    /**
+     * Invokes each bound function in the order they were bound and returns the most recent function's returned value.<br/>
+     * Bound functions may modify this event. Those changes are deferred until the outermost invoke returns, so no copies are made.
+     * Arguments are passed to each function as they are or by const reference (see event_parameter), so only functions taking them by value copy them.
+     */
+    T invoke(event_parameter<A>... args) {
+        const invocation guard(*this);
+        const size_t size = bindings.size();
+        if constexpr (std::is_void_v<T>) {
+            for (size_t i = 0; i < size; ++i) {
+                if (bindings[i].slot != NO_SLOT) {
+                    bindings[i].second(args...);
+                }
             }
-            pair.second(args...);
+        }
+        else {
+            T result = T();
+            for (size_t i = 0; i < size; ++i) {
+                if (bindings[i].slot != NO_SLOT) {
+                    result = bindings[i].second(args...);
+                }
+            }
+            return result;
         }
     }
 
-    /** Invokes each bound function with the given arguments and returns the most recent function's returned value. */
-    void invoke(A... args) const {
-        for (auto &pair : bindings) {
-            if (pair.second == nullptr) {
-                throw std::runtime_error("ERROR: Attempted to invoke an invalid function in an event!");
+    /**
+     * Invokes the bound functions in parallel across the shared thread pool and returns the most recent function's returned value.<br/>
+     * Bound functions are split into contiguous chunks that the pool's threads run while the caller waits on a latch, so they
+     * may run in any order and at the same time. Bound functions must not modify this event or share state without synchronizing.
+     */
+    T invoke_parallel(event_parameter<A>... args) {
+        if constexpr (std::is_void_v<T>) {
+            const invocation guard(*this);
+            worker_pool &pool = worker_pool::shared();
+            const size_t size = bindings.size();
+            const size_t chunks = chunk_count(pool, size);
+            pool.run(chunks, [&](const size_t chunk) {
+                for (size_t i = size * chunk / chunks, end = size * (chunk + 1) / chunks; i < end; ++i) {
+                    if (bindings[i].slot != NO_SLOT) {
+                        bindings[i].second(args...);
+                    }
+                }
+            });
+        }
+        else {
+            return invoke_parallel([](const T &, T next) {
+                return next;
+            }, T(), args...);
+        }
+    }
+
+    /**
+     * Invokes the bound functions in parallel across the shared thread pool and combines their returned values with the given
+     * reduction, starting from the given initial value. reduce(T, T) must be associative: values are combined in the order the
+     * functions were bound, but grouped by chunk. Bound functions must not modify this event or share state without synchronizing.
+     */
+    template <typename F, typename U = T>
+    U invoke_parallel(F &&reduce, typename std::enable_if<!std::is_void_v<U>, U>::type initial, event_parameter<A>... args) {
+        const invocation guard(*this);
+        worker_pool &pool = worker_pool::shared();
+        const size_t size = bindings.size();
+        const size_t chunks = chunk_count(pool, size);
+        std::vector<std::optional<U>> results(chunks);
+        pool.run(chunks, [&](const size_t chunk) {
+            std::optional<U> &result = results[chunk];
+            for (size_t i = size * chunk / chunks, end = size * (chunk + 1) / chunks; i < end; ++i) {
+                if (bindings[i].slot != NO_SLOT) {
+                    if (result.has_value()) {
+                        *result = reduce(std::move(*result), bindings[i].second(args...));
+                    }
+                    else {
+                        result.emplace(bindings[i].second(args...));
+                    }
+                }
+            }
+        });
+        for (auto &result : results) {
+            if (result.has_value()) {
+                initial = reduce(std::move(initial), std::move(*result));
             }
-            pair.second(args...);
         }
+        return initial;
     }
 
-    /** Unbinds all functions from this event. */
+    /** Unbinds all functions from this event. Every connection is disconnected. */
     void clear() {
-        bindings.clear();
+        for (auto &bound : bindings) {
+            if (bound.slot != NO_SLOT) {
+                free_slot_at(bound.slot);
+                bound.slot = NO_SLOT;
+                ++dead;
+                ++doomed;
+            }
+        }
+        for (auto &bound : pending) {
+            if (bound.slot != NO_SLOT) {
+                free_slot_at(bound.slot);
+            }
+        }
+        pending.clear();
+        live = 0;
+        if (depth == 0) {
+            bindings.clear();
+            dead = 0;
+            doomed = 0;
+        }
     }
 };
 
 // ID
 
-/** Creates a string ID from the given data's address. */
+/** Creates an ID from the given data's address. */
 template <typename T>
-static std::string make_id(const T &data) {
-    return std::to_string(reinterpret_cast<uintptr_t>(&data));
+static uintptr_t make_id(const T &data) {
+    return reinterpret_cast<uintptr_t>(&data);
 }
 
 // UNWRAP METHOD
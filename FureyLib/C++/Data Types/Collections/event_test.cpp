@@ -0,0 +1,457 @@
+// .cpp
+// Event Tests
+// by Kyle Furey
+
+#include "event.hpp"
+#include "concurrent_event.hpp"
+#include "queued_event.hpp"
+#include "static_event.hpp"
+#include <cassert>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+// TESTS
+
+/** Tests that a delegate forwards a move-only argument to its function by rvalue reference. */
+static void test_move_only_delegate() {
+    static_assert(std::is_same_v<event_parameter<std::unique_ptr<int>>, std::unique_ptr<int> &&>);
+    delegate<int(std::unique_ptr<int>)> take = [](std::unique_ptr<int> value) {
+        return *value;
+    };
+    assert(take(std::make_unique<int>(7)) == 7);
+
+    std::unique_ptr<int> kept = std::make_unique<int>(8);
+    delegate<int(std::unique_ptr<int> &&)> borrow = [](std::unique_ptr<int> &&value) {
+        return *value;
+    };
+    assert(borrow(std::move(kept)) == 8 && kept != nullptr);
+}
+
+/** Tests that small and large delegates keep their state through copies and moves and destroy it exactly once. */
+static void test_delegate_storage() {
+    const std::shared_ptr<int> token = std::make_shared<int>(5);
+    delegate<int(int)> small = [token](const int value) {
+        return *token + value;
+    };
+    std::array<int, EVENT_DELEGATE_SIZE> padding = {};
+    padding[0] = 10;
+    delegate<int(int)> large = [token, padding](const int value) {
+        return *token + padding[0] + value;
+    };
+    assert(token.use_count() == 3);
+    {
+        delegate<int(int)> copy = small;
+        delegate<int(int)> large_copy = large;
+        assert(copy(1) == 6 && large_copy(1) == 16);
+        assert(token.use_count() == 5);
+        delegate<int(int)> moved = std::move(large_copy);
+        assert(large_copy == nullptr && moved(2) == 17);
+        assert(token.use_count() == 5);
+        copy = moved;
+        assert(copy(0) == 15 && token.use_count() == 5);
+    }
+    assert(token.use_count() == 3);
+    small = nullptr;
+    large = nullptr;
+    assert(token.use_count() == 1);
+    delegate<int(int)> pointer = [](const int value) {
+        return -value;
+    };
+    assert(pointer != nullptr && pointer(4) == -4);
+}
+
+/** Tests that an event passes a move-only argument taken by lvalue reference to each bound function. */
+static void test_move_only_event() {
+    event<void, std::unique_ptr<int> &> changed;
+    int total = 0;
+    changed.bind(1, [&](std::unique_ptr<int> &value) {
+        total += *value;
+    });
+    changed.bind(2, [&](const std::unique_ptr<int> &value) {
+        total += *value;
+    });
+    std::unique_ptr<int> value = std::make_unique<int>(3);
+    changed.invoke(value);
+    assert(total == 6 && value != nullptr);
+}
+
+/** Tests that a connection whose slot was reused by a later bind no longer refers to any function, even after compaction. */
+static void test_connection_reuse() {
+    event<int> fired;
+    const event<int>::connection first = fired.bind(1, []() {
+        return 1;
+    });
+    assert(fired.unbind(first) && !fired.is_bound(first));
+    const event<int>::connection second = fired.bind(2, []() {
+        return 2;
+    });
+    assert(!fired.is_bound(first) && fired.is_bound(second));
+    assert(!fired.unbind(first) && fired.count() == 1 && fired.invoke() == 2);
+
+    std::vector<event<int>::connection> connections;
+    for (int i = 0; i < 16; ++i) {
+        connections.push_back(fired.bind(static_cast<uintptr_t>(i + 10), [i]() {
+            return i + 10;
+        }));
+    }
+    for (int i = 0; i < 12; ++i) {
+        assert(fired.unbind(connections[i]));
+    }
+    assert(fired.count() == 5 && fired.is_bound(second) && fired.invoke() == 25);
+    for (int i = 12; i < 16; ++i) {
+        assert(fired.is_bound(connections[i]));
+    }
+    assert(fired.unbind(connections[15]) && fired.invoke() == 24);
+    for (int i = 0; i < 12; ++i) {
+        assert(!fired.is_bound(connections[i]) && !fired.unbind(connections[i]));
+    }
+    assert(!fired.is_bound(event<int>::connection()));
+}
+
+/** Tests that functions bound by a function that throws are applied while the exception unwinds the invoke. */
+static void test_bind_then_throw() {
+    event<void> fired;
+    int calls = 0;
+    fired.bind(1, [&]() {
+        fired.bind(2, [&]() {
+            ++calls;
+        });
+        throw std::runtime_error("thrown");
+    });
+    bool threw = false;
+    try {
+        fired.invoke();
+    }
+    catch (const std::runtime_error &) {
+        threw = true;
+    }
+    assert(threw && !fired.is_invoking() && fired.count() == 2);
+    fired.unbind(1);
+    fired.invoke();
+    assert(calls == 1);
+}
+
+/** Tests that a copy of an event made during an invoke is not being invoked and calls the functions bound before it was copied. */
+static void test_copy_during_invoke() {
+    event<void> fired;
+    event<void> copy;
+    int calls = 0;
+    fired.bind(1, [&]() {
+        fired.bind(2, [&]() {
+            calls += 10;
+        });
+        copy = fired;
+        event<void> constructed = fired;
+        assert(!constructed.is_invoking() && constructed.count() == 2);
+    });
+    fired.invoke();
+    assert(!copy.is_invoking() && copy.count() == 2);
+    copy.unbind(1);
+    copy.bind(3, [&]() {
+        ++calls;
+    });
+    copy.invoke();
+    assert(calls == 11);
+}
+
+/** Tests that functions unbound during an invoke are destroyed when it returns, and later invokes still call the rest. */
+static void test_unbind_during_invoke() {
+    event<void> fired;
+    const std::shared_ptr<int> token = std::make_shared<int>(0);
+    int calls = 0;
+    for (int i = 0; i < 8; ++i) {
+        fired.bind(static_cast<uintptr_t>(i + 1), [&calls]() {
+            ++calls;
+        });
+    }
+    fired.bind(100, [token, &fired]() {
+        fired.unbind(100);
+    });
+    assert(token.use_count() == 2);
+    fired.invoke();
+    assert(token.use_count() == 1 && fired.count() == 8);
+    fired.invoke();
+    assert(calls == 16);
+}
+/** Tests that a function unbinding others during an invoke stops later ones from being called by it, and that functions bound during it can be unbound. */
+static void test_unbind_others_during_invoke() {
+    event<void> fired;
+    std::vector<int> calls;
+    event<void>::connection first;
+    event<void>::connection last;
+    event<void>::connection added;
+    first = fired.bind(1, [&]() {
+        calls.push_back(1);
+    });
+    fired.bind(2, [&]() {
+        calls.push_back(2);
+        assert(fired.unbind(first) && fired.unbind(last));
+        added = fired.bind(4, [&]() {
+            calls.push_back(4);
+        });
+        assert(fired.is_bound(added) && fired.unbind(added) && !fired.is_bound(added));
+    });
+    last = fired.bind(3, [&]() {
+        calls.push_back(3);
+    });
+    fired.invoke();
+    assert((calls == std::vector<int>{1, 2}));
+    assert(fired.count() == 1 && !fired.is_bound(first) && !fired.is_bound(last));
+    fired.unbind(2);
+    fired.invoke();
+    assert((calls == std::vector<int>{1, 2}) && fired.count() == 0);
+}
+/** Tests that functions bound and unbound while other threads invoke a concurrent event are called exactly while they are bound. */
+static void test_concurrent_bind_during_invoke() {
+    concurrent_event<void, int> fired;
+    std::atomic<long long> always(0);
+    std::atomic<long long> sometimes(0);
+    std::atomic<bool> running(true);
+    std::atomic<long long> invokes(0);
+    fired.bind(1, [&](const int value) {
+        always.fetch_add(value);
+    });
+    std::vector<std::thread> invokers;
+    for (int thread = 0; thread < 4; ++thread) {
+        invokers.emplace_back([&]() {
+            while (running.load()) {
+                fired.invoke(1);
+                invokes.fetch_add(1);
+            }
+        });
+    }
+    for (int i = 0; i < 2000; ++i) {
+        const concurrent_event<void, int>::connection bound = fired.bind(2, [&](const int value) {
+            sometimes.fetch_add(value);
+        });
+        assert(fired.is_bound(bound) && fired.count() == 2);
+        assert(fired.unbind(bound) && !fired.is_bound(bound));
+    }
+    running.store(false);
+    for (std::thread &invoker : invokers) {
+        invoker.join();
+    }
+    fired.synchronize();
+    assert(always.load() == invokes.load() && fired.count() == 1);
+    const long long called = sometimes.load();
+    fired.invoke(1);
+    assert(sometimes.load() == called && always.load() == invokes.load() + 1);
+}
+
+/** Tests that a parallel invoke calls each bound function once and reduces their values in the order they were bound. */
+static void test_invoke_parallel() {
+    event<long long, int> summed;
+    event<std::string> joined;
+    std::string expected;
+    for (int i = 0; i < 1000; ++i) {
+        summed.bind(static_cast<uintptr_t>(i + 1), [i](const int scale) {
+            return static_cast<long long>(i) * scale;
+        });
+        joined.bind(static_cast<uintptr_t>(i + 1), [i]() {
+            return std::to_string(i) + ',';
+        });
+        expected += std::to_string(i) + ',';
+    }
+    assert(summed.invoke_parallel([](const long long total, const long long next) {
+        return total + next;
+    }, 7, 2) == 7 + 2 * 499500);
+    assert(summed.invoke_parallel(3) == 999 * 3);
+    assert(joined.invoke_parallel([](std::string total, const std::string &next) {
+        return total + next;
+    }, std::string()) == expected);
+
+    event<void> counted;
+    std::vector<std::atomic<int>> calls(257);
+    for (size_t i = 0; i < calls.size(); ++i) {
+        counted.bind(static_cast<uintptr_t>(i + 1), [&calls, i]() {
+            calls[i].fetch_add(1);
+        });
+    }
+    counted.unbind(5);
+    counted.invoke_parallel();
+    for (size_t i = 0; i < calls.size(); ++i) {
+        assert(calls[i].load() == (i == 4 ? 0 : 1));
+    }
+}
+
+/** Tests that queued invocations are pumped in order, up to a limit, from several producers, and that a full ring rejects posts. */
+static void test_queued_pump() {
+    queued_event<void, int> posted(8);
+    std::vector<int> values;
+    posted.bindings().bind(1, [&](const int value) {
+        values.push_back(value);
+    });
+    for (int i = 0; i < 8; ++i) {
+        assert(posted.post(i));
+    }
+    assert(!posted.post(8));
+    assert(posted.pump(3) == 3 && (values == std::vector<int>{0, 1, 2}));
+    assert(posted.pump() == 5 && values.size() == 8 && values.back() == 7);
+    assert(posted.pump() == 0);
+
+    queued_event<void, int> shared(4096);
+    long long total = 0;
+    shared.bindings().bind(1, [&](const int value) {
+        total += value;
+    });
+    std::vector<std::thread> producers;
+    for (int thread = 0; thread < 4; ++thread) {
+        producers.emplace_back([&]() {
+            for (int i = 1; i <= 1000; ++i) {
+                while (!shared.post(i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (std::thread &producer : producers) {
+        producer.join();
+    }
+    assert(shared.pump() == 4000 && total == 4 * 500500);
+}
+
+/** Tests that a coalescing pump dispatches only the most recent invocation of each key, in the order they were posted. */
+static void test_queued_coalescing() {
+    queued_event<void, int, int> moved(16);
+    std::vector<std::pair<int, int>> dispatched;
+    moved.bindings().bind(1, [&](const int entity, const int position) {
+        dispatched.emplace_back(entity, position);
+    });
+    moved.post(1, 10);
+    moved.post(2, 20);
+    moved.post(1, 11);
+    moved.post(3, 30);
+    moved.post(2, 21);
+    assert(moved.pump_coalesced(SIZE_MAX, [](const int entity, int) {
+        return entity;
+    }) == 5);
+    assert((dispatched == std::vector<std::pair<int, int>>{{1, 11}, {3, 30}, {2, 21}}));
+
+    dispatched.clear();
+    moved.post(1, 10);
+    moved.post(1, 10);
+    moved.post(1, 11);
+    moved.post(1, 10);
+    moved.post(4, 40);
+    assert(moved.pump_coalesced(4) == 4);
+    assert((dispatched == std::vector<std::pair<int, int>>{{1, 11}, {1, 10}}));
+    assert(moved.pump_coalesced() == 1 && dispatched.back() == std::make_pair(4, 40));
+}
+
+/** An argument whose constructor throws for negative values. */
+struct checked_value final {
+    /** The value. */
+    int value;
+
+    /** Constructs the given value, throwing if it is negative. */
+    checked_value(const int value) : value(value) {
+        if (value < 0) {
+            throw std::runtime_error("negative");
+        }
+    }
+};
+
+/** Tests that an invocation whose arguments throw while being posted is skipped, and later invocations are still pumped. */
+static void test_post_then_throw() {
+    queued_event<void, checked_value> posted(4);
+    int total = 0;
+    posted.bindings().bind(1, [&](const checked_value &checked) {
+        total += checked.value;
+    });
+    for (int lap = 0; lap < 4; ++lap) {
+        assert(posted.post(1));
+        bool threw = false;
+        try {
+            posted.post(-1);
+        }
+        catch (const std::runtime_error &) {
+            threw = true;
+        }
+        assert(threw);
+        assert(posted.post(2));
+        assert(posted.pump() == 2);
+    }
+    assert(total == 12);
+}
+
+/** Returns the given value plus one. */
+static constexpr int add_one(const int value) {
+    return value + 1;
+}
+
+/** Returns twice the given value. */
+static constexpr int twice(const int value) {
+    return value * 2;
+}
+
+/** Appends the given value to the given list. */
+static void record(std::vector<int> &list, const int value) {
+    list.push_back(value);
+}
+
+/** A listener whose method is bound to a static event. */
+struct recorder final {
+    /** The values this recorder received. */
+    std::vector<int> values;
+
+    /** Records the given value negated. */
+    void negate(const int value) {
+        values.push_back(-value);
+    }
+};
+
+/** Appends the given recorder's value count to its values. */
+static void record_count(recorder &listener, int) {
+    listener.values.push_back(static_cast<int>(listener.values.size()));
+}
+
+/** Tests that a static event calls its functions and methods in order with the same arguments, and can be invoked at compile time. */
+static void test_static_event() {
+    using computed = static_event<&add_one, &twice>;
+    static_assert(computed::count() == 2);
+    static_assert(computed::is_bound<&twice>() && !computed::is_bound<&record>());
+    static_assert(computed::invoke(3) == 6);
+    assert(computed()(5) == 10);
+
+    std::vector<int> list;
+    int value = 4;
+    static_event<&record>::invoke(list, value);
+    assert((list == std::vector<int>{4}));
+
+    recorder listener;
+    static_event<&recorder::negate, &record_count, &recorder::negate>::invoke(listener, 7);
+    assert((listener.values == std::vector<int>{-7, 1, -7}));
+
+    static_event<>::invoke(listener, 1);
+    static_assert(static_event<>::count() == 0);
+    assert(listener.values.size() == 3);
+}
+
+
+// MAIN
+
+/** Entry point of the program. */
+int main() {
+    test_move_only_delegate();
+    test_delegate_storage();
+    test_move_only_event();
+    test_connection_reuse();
+    test_bind_then_throw();
+    test_copy_during_invoke();
+    test_unbind_during_invoke();
+    test_unbind_others_during_invoke();
+    test_concurrent_bind_during_invoke();
+    test_invoke_parallel();
+    test_queued_pump();
+    test_queued_coalescing();
+    test_post_then_throw();
+    test_static_event();
+    std::printf("Event tests passed!\n");
+    return 0;
+}
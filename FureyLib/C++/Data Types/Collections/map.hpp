@@ -5,6 +5,7 @@
 #pragma once
 #include <vector>
 #include <list>
+#include <memory_resource>
 #include <utility>
 #include <cstdlib>
 
@@ -42,14 +43,14 @@ class map final {
     size_t count;
 
     /** An array of buckets holding each key-value pair. */
-    std::vector<std::list<pair>> pairs;
+    std::pmr::vector<std::pmr::list<pair>> pairs;
 
 public:
 
     // CONSTRUCTOR
 
-    /** Default constructor. */
-    map(const size_t buckets = 16) : count(0), pairs(buckets) {
+    /** Default constructor. Buckets and pairs are allocated from the given memory resource. */
+    map(const size_t buckets = 16, std::pmr::memory_resource *resource = std::pmr::get_default_resource()) : count(0), pairs(buckets, resource) {
     }
 
 
@@ -65,19 +66,24 @@ public:
         return pairs.size();
     }
 
+    /** Returns the memory resource this map allocates from. */
+    std::pmr::memory_resource *resource() const noexcept {
+        return pairs.get_allocator().resource();
+    }
+
     /** Moves all elements to a new set of buckets. */
     void rehash(const size_t buckets) {
         if (buckets == 0 || buckets == pairs.size()) {
             return;
         }
-        std::vector<std::list<pair>> new_pairs(buckets);
+        std::pmr::vector<std::pmr::list<pair>> new_pairs(buckets, pairs.get_allocator());
         for (auto &bucket : pairs) {
             for (auto &elem : bucket) {
                 const size_t index = elem.hash % new_pairs.size();
                 new_pairs[index].push_back(elem);
             }
         }
-        pairs = std::move(new_pairs);
+        pairs.swap(new_pairs);
     }
 
     /** Returns a pointer to the value with the given key (or nullptr). */
@@ -0,0 +1,276 @@
+// .hpp
+// Queued Multicast Event Type
+// by Kyle Furey
+
+#pragma once
+#include "event.hpp"
+#include <atomic>
+#include <memory>
+#include <tuple>
+#include <optional>
+#include <vector>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+
+
+// QUEUED EVENT
+
+/**
+ * A multicast event whose invocations are queued and dispatched later on a chosen thread.<br/>
+ * Any number of threads post() arguments into a fixed-size lock-free ring without allocating. One thread at a time pump()s
+ * the ring, invoking the bound functions on that thread, so producers never wait for slow listeners.
+ */
+template <typename T, typename... A>
+class queued_event final {
+public:
+
+    // TYPES
+
+    /** The type of function bound to this event. */
+    using target = typename event<T, A...>::target;
+
+    /** The arguments of one queued invocation, stored by value. */
+    using arguments = std::tuple<std::decay_t<A>...>;
+
+private:
+
+    // CELL
+
+    /** One slot of the ring. Its sequence number says whether it is free or holds arguments for the current lap. */
+    struct cell final {
+
+        // DATA
+
+        /** The position this cell may be written at next, or that position + 1 once it is written. */
+        std::atomic<size_t> sequence;
+
+        /** Whether constructing the queued arguments threw, so this cell holds nothing and is stepped over. */
+        bool skipped;
+
+        /** The queued arguments. */
+        alignas(arguments) unsigned char storage[sizeof(arguments)];
+
+
+        // CELL
+
+        /** Returns the queued arguments. */
+        arguments *get() noexcept {
+            return std::launder(reinterpret_cast<arguments *>(storage));
+        }
+    };
+
+
+    // DATA
+
+    /** The bound functions. */
+    event<T, A...> listeners;
+
+    /** The ring of queued invocations. */
+    std::unique_ptr<cell[]> cells;
+
+    /** The number of cells minus one. The number of cells is a power of two. */
+    size_t mask;
+
+    /** The position of the next invocation to dispatch. Only read and written by the pumping thread. */
+    size_t head;
+
+    /** The position of the next invocation to post. */
+    alignas(64) std::atomic<size_t> tail;
+
+    /** Spare storage for the invocations taken by a coalescing pump, kept to reuse its capacity. */
+    std::vector<arguments> batch;
+
+
+    // QUEUED EVENT
+
+    /** Moves the next queued invocation into the given output and frees its cell, stepping over skipped cells. Returns false if the ring is empty. */
+    bool take(std::optional<arguments> &out) {
+        while (true) {
+            cell &next = cells[head & mask];
+            if (next.sequence.load(std::memory_order_acquire) != head + 1) {
+                return false;
+            }
+            const bool skipped = next.skipped;
+            if (!skipped) {
+                out.emplace(std::move(*next.get()));
+                next.get()->~arguments();
+            }
+            next.sequence.store(head + mask + 1, std::memory_order_release);
+            ++head;
+            if (!skipped) {
+                return true;
+            }
+        }
+    }
+
+    /** Invokes the bound functions with the given arguments. */
+    void dispatch(arguments &values) {
+        std::apply([this](auto &...unpacked) {
+            listeners.invoke(unpacked...);
+        }, values);
+    }
+
+public:
+
+    // CONSTRUCTORS AND DESTRUCTOR
+
+    /** Constructs a queued event that can hold at least the given number of invocations. */
+    explicit queued_event(const size_t capacity = 1024) : listeners(), cells(), mask(0), head(0), tail(0), batch() {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        cells.reset(new cell[size]);
+        mask = size - 1;
+        for (size_t i = 0; i < size; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /** Delete copy constructor. */
+    queued_event(const queued_event &) = delete;
+
+    /** Destructor. Discards invocations that were never pumped. */
+    ~queued_event() {
+        for (size_t position = head; cells[position & mask].sequence.load(std::memory_order_acquire) == position + 1; ++position) {
+            if (!cells[position & mask].skipped) {
+                cells[position & mask].get()->~arguments();
+            }
+        }
+    }
+
+
+    // OPERATORS
+
+    /** Delete copy assignment operator. */
+    queued_event &operator=(const queued_event &) = delete;
+
+    /** Binds a new function to this event. Not thread safe: bind on the pumping thread. */
+    queued_event &operator+=(const target &callback) {
+        listeners += callback;
+        return *this;
+    }
+
+    /** Unbinds the first instance of the given function from this event. Not thread safe: unbind on the pumping thread. */
+    queued_event &operator-=(const target &callback) {
+        listeners -= callback;
+        return *this;
+    }
+
+
+    // QUEUED EVENT
+
+    /** Returns the functions bound to this event. Not thread safe: modify them on the pumping thread. */
+    event<T, A...> &bindings() noexcept {
+        return listeners;
+    }
+
+    /** Returns the number of invocations the ring can hold. */
+    size_t capacity() const noexcept {
+        return mask + 1;
+    }
+
+    /**
+     * Queues an invocation with the given arguments. Lock-free and thread safe. Returns false if the ring is full.<br/>
+     * If constructing the arguments throws, their cell is published as skipped so later invocations are still pumped, and the exception is rethrown.
+     */
+    template <typename... P>
+    bool post(P &&...args) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        cell *next;
+        while (true) {
+            next = &cells[position & mask];
+            const size_t sequence = next->sequence.load(std::memory_order_acquire);
+            const ptrdiff_t lap = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(position);
+            if (lap == 0) {
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (lap < 0) {
+                return false;
+            }
+            else {
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+        try {
+            new (next->storage) arguments(std::forward<P>(args)...);
+        }
+        catch (...) {
+            next->skipped = true;
+            next->sequence.store(position + 1, std::memory_order_release);
+            throw;
+        }
+        next->skipped = false;
+        next->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Dispatches up to the given number of queued invocations in the order they were posted and returns how many were dispatched.<br/>
+     * Only one thread may pump at a time. Each invocation's cell is freed before its functions run.
+     */
+    size_t pump(const size_t max_items = SIZE_MAX) {
+        size_t dispatched = 0;
+        std::optional<arguments> values;
+        while (dispatched < max_items && take(values)) {
+            dispatch(*values);
+            ++dispatched;
+        }
+        return dispatched;
+    }
+
+    /**
+     * Takes up to the given number of queued invocations and dispatches only the most recent invocation of each key,
+     * in the order they were posted. Returns how many invocations were taken. The key function receives the arguments
+     * and must return a value comparable with ==. Only one thread may pump at a time, but bound functions may pump again.<br/>
+     * Keys are compared pairwise, so coalescing costs O(n^2) key comparisons in the number of invocations taken. Keep max_items small.
+     */
+    template <typename K>
+    size_t pump_coalesced(const size_t max_items, K &&key) {
+        std::vector<arguments> taken_batch;
+        taken_batch.swap(batch);
+        taken_batch.clear();
+        std::optional<arguments> values;
+        while (taken_batch.size() < max_items && take(values)) {
+            taken_batch.push_back(std::move(*values));
+        }
+        const size_t taken = taken_batch.size();
+        size_t kept = taken;
+        for (size_t i = taken; i-- > 0;) {
+            const auto current = std::apply(key, std::as_const(taken_batch[i]));
+            bool superseded = false;
+            for (size_t j = kept; j < taken; ++j) {
+                if (std::apply(key, std::as_const(taken_batch[j])) == current) {
+                    superseded = true;
+                    break;
+                }
+            }
+            if (!superseded) {
+                --kept;
+                if (kept != i) {
+                    taken_batch[kept] = std::move(taken_batch[i]);
+                }
+            }
+        }
+        for (size_t i = kept; i < taken; ++i) {
+            dispatch(taken_batch[i]);
+        }
+        taken_batch.clear();
+        if (taken_batch.capacity() > batch.capacity()) {
+            batch.swap(taken_batch);
+        }
+        return taken;
+    }
+
+    /** Takes up to the given number of queued invocations and dispatches each distinct set of arguments once, at its most recent position. */
+    size_t pump_coalesced(const size_t max_items = SIZE_MAX) {
+        return pump_coalesced(max_items, [](const std::decay_t<A> &...unpacked) {
+            return std::forward_as_tuple(unpacked...);
+        });
+    }
+};
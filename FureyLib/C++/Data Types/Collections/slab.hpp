@@ -7,6 +7,8 @@
 #include <vector>
 #include <queue>
 #include <optional>
+#include <deque>
+#include <memory_resource>
 #include <utility>
 #include <stdexcept>
 
@@ -28,10 +30,10 @@ private:
 	// DATA
 
 	/** The underlying array of objects in the slab. */
-	std::vector<std::optional<T>> objects;
+	std::pmr::vector<std::optional<T>> objects;
 
 	/** Each ID that can be reused in the slab. */
-	std::queue<id> next_ids;
+	std::queue<id, std::pmr::deque<id>> next_ids;
 
 	/** The current number of objects in the slab. */
 	size_t total;
@@ -40,8 +42,9 @@ public:
 
 	// CONSTRUCTOR
 
-	/** Default constructor. */
-	slab(const size_t capacity = 16) : objects(capacity), next_ids(), total(0) {
+	/** Default constructor. Objects and IDs are allocated from the given memory resource. */
+	slab(const size_t capacity = 16, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) :
+		objects(capacity, resource), next_ids(std::pmr::deque<id>(resource)), total(0) {
 		for (size_t i = 0; i < capacity; ++i) {
 			next_ids.push(i);
 		}
@@ -101,6 +104,11 @@ public:
 		return objects.size();
 	}
 
+	/** Returns the memory resource this slab allocates from. */
+	std::pmr::memory_resource* resource() const noexcept {
+		return objects.get_allocator().resource();
+	}
+
 	/** Adds the object to the slab and returns its unique ID. */
 	id insert(const T& obj) {
 		if (next_ids.empty()) {
@@ -165,7 +173,7 @@ public:
 	/** Clears the slab of all its objects. */
 	void clear(const size_t capacity = 16) {
 		objects.clear();
-		next_ids = std::queue<id>();
+		next_ids = std::queue<id, std::pmr::deque<id>>(std::pmr::deque<id>(resource()));
 		total = 0;
 		for (size_t i = 0; i < capacity; ++i) {
 			next_ids.push(i);
@@ -0,0 +1,92 @@
+// .hpp
+// Compile-Time Multicast Event Type
+// by Kyle Furey
+
+#pragma once
+#include <functional>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
+
+
+// STATIC EVENT
+
+/**
+ * A multicast event whose functions are fixed at compile time, for hooks whose listeners are known when building.<br/>
+ * Each function is called directly, so invoking has no indirection, never allocates, and can be fully inlined.
+ * Functions are invoked in the order they are listed. Methods are called on the first argument.
+ */
+template <auto... F>
+class static_event final {
+
+    // STATIC EVENT
+
+    /** Calls the given function with the given arguments. */
+    template <auto FUNCTION, typename... P>
+    static constexpr decltype(auto) call_one(P &...args) {
+        if constexpr (std::is_member_pointer_v<decltype(FUNCTION)>) {
+            return std::invoke(FUNCTION, args...);
+        }
+        else {
+            return FUNCTION(args...);
+        }
+    }
+
+    /** Calls each of the given functions with the given arguments and returns the last function's returned value. */
+    template <auto FIRST, auto... REST, typename... P>
+    static constexpr decltype(auto) call(P &...args) {
+        if constexpr (sizeof...(REST) == 0) {
+            return call_one<FIRST>(args...);
+        }
+        else {
+            call_one<FIRST>(args...);
+            return call<REST...>(args...);
+        }
+    }
+
+    /** Returns whether both functions are the same function. */
+    template <auto FUNCTION, auto OTHER>
+    static constexpr bool same() noexcept {
+        if constexpr (std::is_same_v<decltype(FUNCTION), decltype(OTHER)>) {
+            return FUNCTION == OTHER;
+        }
+        else {
+            return false;
+        }
+    }
+
+public:
+
+    // OPERATORS
+
+    /** Invokes each function with the given arguments and returns the last function's returned value. */
+    template <typename... P>
+    constexpr decltype(auto) operator()(P &&...args) const {
+        return invoke(std::forward<P>(args)...);
+    }
+
+
+    // STATIC EVENT
+
+    /** Returns the total number of functions. */
+    static constexpr size_t count() noexcept {
+        return sizeof...(F);
+    }
+
+    /** Returns whether the given function is one of this event's functions. */
+    template <auto FUNCTION>
+    static constexpr bool is_bound() noexcept {
+        return (same<FUNCTION, F>() || ...);
+    }
+
+    /**
+     * Invokes each function in order with the given arguments and returns the last function's returned value.<br/>
+     * Arguments are passed to every function as the same lvalues, so they are never copied unless a function takes them by value.
+     */
+    template <typename... P>
+    static constexpr decltype(auto) invoke(P &&...args) {
+        if constexpr (sizeof...(F) != 0) {
+            return call<F...>(args...);
+        }
+    }
+};
@@ -0,0 +1,227 @@
+// .hpp
+// Compile-Time Schema Table Type
+// by Kyle Furey
+
+#pragma once
+#include "table.hpp"
+#include <string>
+#include <string_view>
+#include <array>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+
+#if __cplusplus < 202002L && (!defined(_MSVC_LANG) || _MSVC_LANG < 202002L)
+#error "ERROR: static_table.hpp requires C++20 for string template arguments!"
+#endif
+
+
+// FIELD NAME
+
+/** A string literal that can be used as a template argument. */
+template <size_t N>
+struct field_name final {
+
+    // DATA
+
+    /** The characters of the name, including the null terminator. */
+    char characters[N];
+
+
+    // CONSTRUCTOR
+
+    /** Constructs a field name from a string literal. */
+    constexpr field_name(const char (&name)[N]) noexcept : characters() {
+        for (size_t i = 0; i < N; ++i) {
+            characters[i] = name[i];
+        }
+    }
+
+
+    // FIELD NAME
+
+    /** Returns the name without its null terminator. */
+    constexpr std::string_view view() const noexcept {
+        return std::string_view(characters, N - 1);
+    }
+};
+
+
+// FIELD
+
+/** A named field of a static table. */
+template <field_name NAME, typename T>
+struct field {
+
+    // TYPES
+
+    /** The type of this field. */
+    using type = T;
+
+
+    // CONSTANTS
+
+    /** The name of this field. */
+    static constexpr std::string_view name = NAME.view();
+
+
+    // DATA
+
+    /** The value of this field. */
+    T value{};
+};
+
+
+// STATIC TABLE
+
+/**
+ * A table whose names and types are fixed at compile time, for example static_table<field<"hp", int>, field<"name", std::string>>.<br/>
+ * Fields are laid out as plain members, so get<"hp">() is a direct member access with no hashing or type erasure.
+ * find<T>(name) and to_string() are still available for tooling that only knows names at runtime.
+ */
+template <typename... F>
+class static_table final : private F... {
+
+    // CONSTANTS
+
+    /** The name of each field in order. */
+    static constexpr std::array<std::string_view, sizeof...(F)> NAMES = {F::name...};
+
+    /** Returns the index of the field with the given name, or the number of fields if it was not found. */
+    static constexpr size_t index_of(const std::string_view name) noexcept {
+        for (size_t i = 0; i < NAMES.size(); ++i) {
+            if (NAMES[i] == name) {
+                return i;
+            }
+        }
+        return NAMES.size();
+    }
+
+    /** Returns whether every field's name is unique. */
+    static constexpr bool unique() noexcept {
+        for (size_t i = 0; i < NAMES.size(); ++i) {
+            if (index_of(NAMES[i]) != i) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static_assert(unique(), "ERROR: Each field of a static_table must have a unique name!");
+
+
+    // TYPES
+
+    /** The field at the given index. */
+    template <size_t I>
+    using field_at = std::tuple_element_t<I, std::tuple<F...>>;
+
+
+    // STATIC TABLE
+
+    /** Returns a pointer to the value of the given field if it has the given name and type (or nullptr). */
+    template <typename T, typename G>
+    T *find_field(const std::string_view name) noexcept {
+        if constexpr (std::is_same_v<typename G::type, std::remove_cv_t<T>>) {
+            if (G::name == name) {
+                return &static_cast<G &>(*this).value;
+            }
+        }
+        return nullptr;
+    }
+
+    /** Appends the given field to the given JSON buffer. */
+    template <typename G>
+    void write_field(std::string &json, const bool pretty_print, bool &first) const {
+        if (!first) {
+            json += ',';
+        }
+        first = false;
+        json += pretty_print ? "\n\t" : " ";
+        table::write_string(G::name, json);
+        json += " : ";
+        table::handler<typename G::type>::write_value(static_cast<const G &>(*this).value, json);
+    }
+
+public:
+
+    // CONSTRUCTORS
+
+    /** Default constructor. Value initializes each field. */
+    static_table() = default;
+
+    /** Constructs each field with the given values in order. */
+    static_table(const typename F::type &...values) requires (sizeof...(F) > 0) : F{values}... {
+    }
+
+
+    // STATIC TABLE
+
+    /** Returns the number of fields. */
+    static constexpr size_t size() noexcept {
+        return sizeof...(F);
+    }
+
+    /** Returns whether the table has a field of the given name. */
+    static constexpr bool contains(const std::string_view name) noexcept {
+        return index_of(name) != sizeof...(F);
+    }
+
+    /** Returns a reference to the field with the given name. */
+    template <field_name NAME>
+    auto &get() noexcept {
+        constexpr size_t INDEX = index_of(NAME.view());
+        static_assert(INDEX < sizeof...(F), "ERROR: static_table has no field of this name!");
+        return static_cast<field_at<INDEX> &>(*this).value;
+    }
+
+    /** Returns a reference to the field with the given name. */
+    template <field_name NAME>
+    const auto &get() const noexcept {
+        constexpr size_t INDEX = index_of(NAME.view());
+        static_assert(INDEX < sizeof...(F), "ERROR: static_table has no field of this name!");
+        return static_cast<const field_at<INDEX> &>(*this).value;
+    }
+
+    /** Returns a pointer to the field with the given name and type (or nullptr). */
+    template <typename T>
+    T *find(const std::string_view name) noexcept {
+        T *result = nullptr;
+        ((result = result != nullptr ? result : find_field<T, F>(name)), ...);
+        return result;
+    }
+
+    /** Returns a pointer to the field with the given name and type (or nullptr). */
+    template <typename T>
+    const T *find(const std::string_view name) const noexcept {
+        return const_cast<static_table *>(this)->template find<const T>(name);
+    }
+
+    /** Appends this table to the given buffer as JSON, in the same format as table. */
+    void to_json(std::string &json, const bool pretty_print = true) const {
+        if constexpr (sizeof...(F) == 0) {
+            json += "{}";
+        }
+        else {
+            json += '{';
+            bool first = true;
+            (write_field<F>(json, pretty_print, first), ...);
+            json += pretty_print ? "\n}" : " }";
+        }
+    }
+
+    /** Converts this table into a JSON string, in the same format as table. */
+    std::string to_string(const bool pretty_print = true) const {
+        std::string json;
+        to_json(json, pretty_print);
+        return json;
+    }
+
+    /** Copies each field into a new dynamic table. */
+    table to_table(std::pmr::memory_resource *resource = std::pmr::get_default_resource()) const {
+        table result(sizeof...(F) * 2, resource);
+        (result.set<typename F::type>(F::name, static_cast<const F &>(*this).value), ...);
+        return result;
+    }
+};
@@ -4,10 +4,49 @@
 
 #pragma once
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <unordered_set>
+#include <mutex>
+#include <memory>
+#include <memory_resource>
+#include <atomic>
+#include <ostream>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <algorithm>
 #include <utility>
+#include <new>
 #include <stdexcept>
 #include <typeinfo>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TABLE_SSE2 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#else
+#define TABLE_SSE2 0
+#endif
+
+#ifndef TABLE_FLOAT_CHARCONV
+// Whether std::to_chars() and std::from_chars() support floating point. Older libc++ and MSVC toolsets only support integers,
+// so floats fall back to snprintf() and strtod(), which expect the "C" locale's decimal point.
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define TABLE_FLOAT_CHARCONV 1
+#else
+#define TABLE_FLOAT_CHARCONV 0
+#endif
+#endif
 
 
 // TO STRING
@@ -23,302 +62,1563 @@ namespace std {
 
 // TABLE
 
-/** A collection of named objects of any type. */
+class table_view;
+
+template <typename... F>
+class static_table;
+
+/**
+ * A collection of named objects of any type.<br/>
+ * Copies share their objects until one of them is modified, so snapshots are O(1).
+ * Once a table has returned a mutable pointer or reference to an object, its copies are deep so that pointer cannot modify them, until the table is next modified.
+ * Pointers and references into a table are invalidated when it is modified.
+ */
 class table final {
+    friend class table_view;
+
+    template <typename... F>
+    friend class static_table;
+
+public:
+
+    // TYPES
+
+    /** A unique integer that identifies a type of object. Comparing IDs never calls typeid. */
+    using type_id = uintptr_t;
+
+    /** The type tag of a value in the binary format. Values are stored as 64-bit little-endian integers or IEEE floats. */
+    enum class binary_type : uint8_t {
+        NONE = 0,
+        BOOL,
+        CHAR,
+        INT8,
+        UINT8,
+        INT16,
+        UINT16,
+        INT32,
+        UINT32,
+        INT64,
+        UINT64,
+        FLOAT,
+        DOUBLE,
+        STRING,
+    };
+
+    /** Returns the binary format tag of the given type, or NONE if it cannot be stored in the binary format. */
+    template <typename T>
+    static constexpr binary_type binary_type_of() noexcept {
+        using U = std::remove_cv_t<T>;
+        if constexpr (std::is_same_v<U, bool>) {
+            return binary_type::BOOL;
+        }
+        else if constexpr (std::is_same_v<U, char>) {
+            return binary_type::CHAR;
+        }
+        else if constexpr (std::is_integral_v<U> && sizeof(U) <= 8) {
+            constexpr binary_type SIGNED[] = {binary_type::INT8, binary_type::INT16, binary_type::INT32, binary_type::INT64};
+            constexpr binary_type UNSIGNED[] = {binary_type::UINT8, binary_type::UINT16, binary_type::UINT32, binary_type::UINT64};
+            constexpr size_t INDEX = sizeof(U) == 1 ? 0 : sizeof(U) == 2 ? 1 : sizeof(U) == 4 ? 2 : 3;
+            return std::is_signed_v<U> ? SIGNED[INDEX] : UNSIGNED[INDEX];
+        }
+        else if constexpr (std::is_same_v<U, float>) {
+            return binary_type::FLOAT;
+        }
+        else if constexpr (std::is_same_v<U, double>) {
+            return binary_type::DOUBLE;
+        }
+        else if constexpr (std::is_same_v<U, std::string>) {
+            return binary_type::STRING;
+        }
+        else {
+            return binary_type::NONE;
+        }
+    }
+
+
+    // CONSTANTS
+
+    /** The type ID of an empty object. */
+    static constexpr type_id NO_TYPE = 0;
+
+    /** The largest size in bytes of an object stored inline in a table slot. Larger objects are stored on the heap. */
+    static constexpr size_t INLINE_SIZE = 32;
+
+    /** The alignment of an object's inline storage. */
+    static constexpr size_t INLINE_ALIGN = alignof(std::max_align_t);
+
+private:
+
+    // OPERATIONS
+
+    /** The type-erased operations of one type of object. The address of a type's operations is its type tag. */
+    struct operations final {
+
+        // DATA
+
+        /** Returns the type of the object. */
+        const std::type_info &(*type)();
+
+        /** Copy constructs the object in the given source storage into the given destination storage. */
+        void (*copy)(const void *source, void *destination);
+
+        /** Move constructs the object in the given source storage into the given destination storage and destroys the source. */
+        void (*move)(void *source, void *destination) noexcept;
+
+        /** Destroys the object in the given storage. */
+        void (*destroy)(void *storage) noexcept;
+
+        /** Converts the object in the given storage into a string. */
+        std::string (*to_string)(const void *storage);
+
+        /** Appends the object in the given storage to the given JSON buffer. */
+        void (*write)(const void *storage, std::string &json);
+
+        /** The binary format tag of the object, or NONE if it cannot be stored in the binary format. */
+        binary_type binary;
+
+        /** Returns the bits of the object in the given storage as stored in the binary format. */
+        uint64_t (*bits)(const void *storage);
+    };
+
+    /** The storage of an object that is too large to store inline. */
+    struct allocation final {
+
+        // DATA
+
+        /** The object's data. */
+        void *data;
+
+        /** The memory resource the object's data was allocated from. */
+        std::pmr::memory_resource *resource;
+    };
+
+    /** Implements the operations of objects of the given type. */
+    template <typename T>
+    struct handler final {
+
+        // CONSTANTS
+
+        /** Whether objects of this type are stored inline rather than on the heap. */
+        static constexpr bool INLINE = sizeof(T) <= INLINE_SIZE && alignof(T) <= INLINE_ALIGN && std::is_nothrow_move_constructible_v<T>;
+
+
+        // HANDLER
+
+        /** Returns a pointer to the object in the given storage. */
+        static T *get(void *storage) {
+            if constexpr (INLINE) {
+                return std::launder(static_cast<T *>(storage));
+            }
+            else {
+                return static_cast<T *>(std::launder(static_cast<allocation *>(storage))->data);
+            }
+        }
+
+        /** Returns a pointer to the object in the given storage. */
+        static const T *get(const void *storage) {
+            if constexpr (INLINE) {
+                return std::launder(static_cast<const T *>(storage));
+            }
+            else {
+                return static_cast<const T *>(std::launder(static_cast<const allocation *>(storage))->data);
+            }
+        }
+
+        /** Constructs a new object in the given storage with the given arguments. Objects that are not inline are allocated from the given resource. */
+        template <typename... A>
+        static void construct(void *storage, std::pmr::memory_resource *resource, A &&...args) {
+            if constexpr (INLINE) {
+                new (storage) T(std::forward<A>(args)...);
+            }
+            else {
+                void *data = resource->allocate(sizeof(T), alignof(T));
+                try {
+                    new (data) T(std::forward<A>(args)...);
+                }
+                catch (...) {
+                    resource->deallocate(data, sizeof(T), alignof(T));
+                    throw;
+                }
+                new (storage) allocation{data, resource};
+            }
+        }
+
+        /** Returns the type of the object. */
+        static const std::type_info &type() {
+            return typeid(T);
+        }
+
+        /** Copy constructs the object in the given source storage into the given destination storage. */
+        static void copy(const void *source, void *destination) {
+            if constexpr (INLINE) {
+                construct(destination, nullptr, *get(source));
+            }
+            else {
+                construct(destination, std::launder(static_cast<const allocation *>(source))->resource, *get(source));
+            }
+        }
+
+        /** Move constructs the object in the given source storage into the given destination storage and destroys the source. */
+        static void move(void *source, void *destination) noexcept {
+            if constexpr (INLINE) {
+                T *moved = get(source);
+                new (destination) T(std::move(*moved));
+                moved->~T();
+            }
+            else {
+                new (destination) allocation(*std::launder(static_cast<allocation *>(source)));
+            }
+        }
+
+        /** Destroys the object in the given storage. */
+        static void destroy(void *storage) noexcept {
+            if constexpr (INLINE) {
+                get(storage)->~T();
+            }
+            else {
+                const allocation *heap = std::launder(static_cast<allocation *>(storage));
+                static_cast<T *>(heap->data)->~T();
+                heap->resource->deallocate(heap->data, sizeof(T), alignof(T));
+            }
+        }
+
+        /** Converts the object in the given storage into a string. */
+        static std::string to_string(const void *storage) {
+            return std::to_string(*get(storage));
+        }
+
+        /** Appends the object in the given storage to the given JSON buffer. */
+        static void write(const void *storage, std::string &json) {
+            write_value(*get(storage), json);
+        }
+
+        /** Appends the given value to the given JSON buffer. */
+        static void write_value(const T &data, std::string &json) {
+            if constexpr (std::is_same_v<T, bool>) {
+                json += data ? "true" : "false";
+            }
+            else if constexpr (std::is_same_v<T, std::string>) {
+                write_string(data, json);
+            }
+            else if constexpr (std::is_arithmetic_v<T>) {
+                if constexpr (std::is_floating_point_v<T>) {
+                    if (!std::isfinite(data)) {
+                        json += "null";
+                        return;
+                    }
+                }
+                char buffer[64];
+#if !TABLE_FLOAT_CHARCONV
+                if constexpr (std::is_floating_point_v<T>) {
+                    const int length = std::snprintf(buffer, sizeof(buffer), "%.*g", std::numeric_limits<T>::max_digits10, static_cast<double>(data));
+                    json.append(buffer, static_cast<size_t>(length));
+                    return;
+                }
+#endif
+                const std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), data);
+                json.append(buffer, result.ptr);
+            }
+            else {
+                json += std::to_string(data);
+            }
+        }
+
+        /** Returns the bits of the object in the given storage as stored in the binary format. */
+        static uint64_t bits(const void *storage) {
+            const T &data = *get(storage);
+            if constexpr (std::is_same_v<T, float>) {
+                uint32_t result;
+                std::memcpy(&result, &data, sizeof(result));
+                return result;
+            }
+            else if constexpr (std::is_same_v<T, double>) {
+                uint64_t result;
+                std::memcpy(&result, &data, sizeof(result));
+                return result;
+            }
+            else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+                return static_cast<uint64_t>(static_cast<int64_t>(data));
+            }
+            else if constexpr (std::is_integral_v<T>) {
+                return static_cast<uint64_t>(data);
+            }
+            else {
+                return 0;
+            }
+        }
+
+        /** The operations of this type of object. */
+        static inline const operations OPERATIONS = {&type, &copy, &move, &destroy, &to_string, &write, binary_type_of<T>(), &bits};
+    };
+
 public:
 
     // OBJECT
 
-    /** A generic, type safe object of any type. */
-    class object {
+    /**
+     * A generic, type safe object of any type. Objects up to INLINE_SIZE bytes are stored without allocating.<br/>
+     * Larger objects are allocated from their table's memory resource, which copies of the object share.
+     */
+    class object final {
+        friend class table;
+
+        // DATA
+
+        /** The operations of this object's type, or nullptr if this object is empty. */
+        const operations *ops;
+
+        /** The inline storage of this object, or a pointer to its data on the heap. */
+        alignas(INLINE_ALIGN) unsigned char storage[INLINE_SIZE];
+
+
+        // OBJECT
+
+        /** Constructs a new value of the given type in this empty object, allocating from the given resource if it is not inline. */
+        template <typename T, typename... A>
+        void emplace(std::pmr::memory_resource *resource, A &&...args) {
+            handler<T>::construct(storage, resource, std::forward<A>(args)...);
+            ops = &handler<T>::OPERATIONS;
+        }
+
+        /** Destroys this object's value. */
+        void reset() noexcept {
+            if (ops != nullptr) {
+                ops->destroy(storage);
+                ops = nullptr;
+            }
+        }
+
     public:
 
-        // DESTRUCTOR
+        // CONSTRUCTORS AND DESTRUCTOR
+
+        /** Default constructor. */
+        object() noexcept : ops(nullptr), storage() {
+        }
+
+        /** Copy constructor. */
+        object(const object &copied) : ops(nullptr), storage() {
+            if (copied.ops != nullptr) {
+                copied.ops->copy(copied.storage, storage);
+                ops = copied.ops;
+            }
+        }
+
+        /** Move constructor. */
+        object(object &&moved) noexcept : ops(nullptr), storage() {
+            if (moved.ops != nullptr) {
+                moved.ops->move(moved.storage, storage);
+                ops = moved.ops;
+                moved.ops = nullptr;
+            }
+        }
 
         /** Destructor. */
-        virtual ~object() = default;
+        ~object() {
+            reset();
+        }
+
+
+        // OPERATORS
+
+        /** Copy assignment operator. */
+        object &operator=(const object &copied) {
+            if (this != &copied) {
+                object temp(copied);
+                reset();
+                *this = std::move(temp);
+            }
+            return *this;
+        }
+
+        /** Move assignment operator. */
+        object &operator=(object &&moved) noexcept {
+            if (this != &moved) {
+                reset();
+                if (moved.ops != nullptr) {
+                    moved.ops->move(moved.storage, storage);
+                    ops = moved.ops;
+                    moved.ops = nullptr;
+                }
+            }
+            return *this;
+        }
 
 
         // OBJECT
 
         /** Returns the type of this object. */
-        virtual const std::type_info &type() const = 0;
+        const std::type_info &type() const {
+            return ops != nullptr ? ops->type() : typeid(void);
+        }
+
+        /** Returns the type ID of this object, or NO_TYPE if it is empty. */
+        type_id id() const noexcept {
+            return reinterpret_cast<type_id>(ops);
+        }
 
         /** Returns whether this object is the given type. */
         template <typename T>
-        bool is() const {
-            return type() == typeid(T);
+        bool is() const noexcept {
+            return ops == &handler<std::remove_cv_t<T>>::OPERATIONS;
+        }
+
+        /** Returns a pointer to this object as the given type, or nullptr if it is a different type. */
+        template <typename T>
+        T *get_if() noexcept {
+            return is<T>() ? handler<std::remove_cv_t<T>>::get(storage) : nullptr;
+        }
+
+        /** Returns a pointer to this object as the given type, or nullptr if it is a different type. */
+        template <typename T>
+        const T *get_if() const noexcept {
+            return is<T>() ? handler<std::remove_cv_t<T>>::get(storage) : nullptr;
         }
 
         /** Casts this object to a reference of the given type. */
         template <typename T>
         T &as() {
-            if (type() != typeid(T)) {
+            T *data = get_if<T>();
+            if (data == nullptr) {
                 throw std::runtime_error(std::string("ERROR: Casting table object of type ") + type().name() + " to type " + typeid(T).name() + '!');
             }
-            return static_cast<templated_object<T> *>(this)->get();
+            return *data;
         }
 
         /** Casts this object to a reference of the given type. */
         template <typename T>
         const T &as() const {
-            if (type() != typeid(T)) {
+            const T *data = get_if<T>();
+            if (data == nullptr) {
                 throw std::runtime_error(std::string("ERROR: Casting table object of type ") + type().name() + " to type " + typeid(T).name() + '!');
             }
-            return static_cast<templated_object<T> *>(this)->get();
+            return *data;
         }
-        
+
         /** Returns a shallow copy of this object. This new object must be deleted! */
-        virtual object *copy() const = 0;
-        
+        object *copy() const {
+            return new object(*this);
+        }
+
         /** Converts this object into a string. */
-        virtual std::string to_string() const = 0;
+        std::string to_string() const {
+            return ops != nullptr ? ops->to_string(storage) : std::string();
+        }
     };
 
-private:
 
-    // TEMPLATED OBJECT
+    // ENTRY
 
-    /** A templated, type safe object of any type. */
-    template <typename T>
-    class templated_object final : public object {
+    /** A named object stored in a table. */
+    struct entry final {
 
         // DATA
 
-        /** The underlying data within this object. */
-        T data;
+        /** The name of this entry. */
+        std::string first;
+
+        /** The object of this entry. */
+        object second;
+    };
+
+
+    // KEY
+
+    /** A name and its precomputed hash, used to look up objects without rehashing the name. */
+    class key final {
+        friend class table;
+
+        // DATA
+
+        /** The name of this key. */
+        std::string_view name;
+
+        /** The precomputed hash of this key's name. */
+        size_t hash;
 
     public:
 
-        // CONSTRUCTORS
+        // CONSTRUCTOR
 
-        /** Default constructor. */
-        templated_object() : data() {
+        /** Hashes the given name. The name's characters must outlive this key (see intern()). */
+        explicit key(const std::string_view name) noexcept : name(name), hash(table::hash(name)) {
         }
 
-        /** Argument constructor. */
-        template <typename... A>
-        explicit templated_object(A &&...args) : data(std::forward<A>(args)...) {
+
+        // KEY
+
+        /** Returns the name of this key. */
+        std::string_view str() const noexcept {
+            return name;
         }
 
+        /** Returns whether both keys have the same name. */
+        bool operator==(const key &other) const noexcept {
+            return hash == other.hash && name == other.name;
+        }
 
-        // TEMPLATED OBJECT
+        /** Returns whether the keys have different names. */
+        bool operator!=(const key &other) const noexcept {
+            return !(*this == other);
+        }
+    };
 
-        /** Returns the type of this object. */
-        const std::type_info &type() const override {
-            return typeid(T);
+
+    // ITERATOR
+
+    /** Iterates each entry in a table. */
+    class const_iterator final {
+        friend class table;
+
+        // DATA
+
+        /** The table being iterated. */
+        const table *owner;
+
+        /** The index of the current slot. */
+        size_t index;
+
+
+        // CONSTRUCTOR
+
+        /** Constructs an iterator at the first used slot at or after the given index. */
+        const_iterator(const table *owner, const size_t index) : owner(owner), index(index) {
+            skip();
         }
 
-        /** Returns a reference to the underlying data within this object. */
-        T &get() {
-            return data;
+        /** Advances this iterator to the next used slot. */
+        void skip() {
+            while (index < owner->shared->hashes.size() && owner->shared->hashes[index] == EMPTY) {
+                ++index;
+            }
         }
 
-        /** Returns a constant reference to the underlying data within this object. */
-        const T &get() const {
-            return data;
+    public:
+
+        // OPERATORS
+
+        /** Returns the current entry. */
+        const entry &operator*() const {
+            return owner->shared->entries[index];
         }
-        
-        /** Returns a shallow copy of this object. This new object must be deleted! */
-        object *copy() const override {
-            return new templated_object<T>(data);
+
+        /** Returns the current entry. */
+        const entry *operator->() const {
+            return &owner->shared->entries[index];
         }
-        
-        /** Converts this object into a string. */
-        std::string to_string() const override {
-            return std::to_string(data);
+
+        /** Advances to the next entry. */
+        const_iterator &operator++() {
+            ++index;
+            skip();
+            return *this;
+        }
+
+        /** Returns whether both iterators point to the same entry. */
+        bool operator==(const const_iterator &other) const {
+            return index == other.index;
+        }
+
+        /** Returns whether the iterators point to different entries. */
+        bool operator!=(const const_iterator &other) const {
+            return index != other.index;
+        }
+    };
+
+private:
+
+    // CONSTANTS
+
+    /** The hash of an empty slot. */
+    static constexpr size_t EMPTY = 0;
+
+    /** The index returned when a name is not found. */
+    static constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+
+
+    // SLOTS
+
+    /** The slots of a table, which are shared between copies until one of them is modified. */
+    struct slots final {
+
+        // DATA
+
+        /** The memory resource of the slots and of each object that is not stored inline. */
+        std::pmr::memory_resource *resource;
+
+        /** The hash of each slot's name, or EMPTY. Probed linearly with a power of two size. */
+        std::pmr::vector<size_t> hashes;
+
+        /** The entry of each slot. */
+        std::pmr::vector<entry> entries;
+
+        /** The number of used slots. */
+        size_t count;
+
+        /** Whether a mutable pointer or reference into these slots has been returned, so they must not be shared by copies. */
+        bool unsharable;
+
+
+        // CONSTRUCTORS
+
+        /** Constructs the given number of empty slots that allocate from the given resource. */
+        slots(const size_t capacity, std::pmr::memory_resource *resource) : resource(resource), hashes(capacity, EMPTY, resource), entries(capacity, resource), count(0), unsharable(false) {
+        }
+
+        /** Copy constructor. Allocates from the same resource. */
+        slots(const slots &copied) : resource(copied.resource), hashes(copied.hashes, copied.resource), entries(copied.entries, copied.resource), count(copied.count), unsharable(false) {
         }
     };
 
 
     // DATA
 
-    /** Each stored object by name. */
-    std::unordered_map<std::string, object *> objects;
+    /** The slots of this table, which may be shared with copies of this table. */
+    std::shared_ptr<slots> shared;
 
-public:
 
-    // CONSTRUCTORS AND DESTRUCTOR
+    // TABLE
+
+    /** Hashes the given name. Never returns EMPTY. */
+    static size_t hash(const std::string_view name) noexcept {
+        const size_t result = std::hash<std::string_view>{}(name);
+        return result != EMPTY ? result : 1;
+    }
+
+    /** Allocates slots from the given resource with the given arguments. */
+    template <typename... A>
+    static std::shared_ptr<slots> make_slots(std::pmr::memory_resource *resource, A &&...args) {
+        return std::allocate_shared<slots>(std::pmr::polymorphic_allocator<slots>(resource), std::forward<A>(args)...);
+    }
+
+    /** Returns the slots of moved-from tables, which are never modified. */
+    static const std::shared_ptr<slots> &empty() {
+        static const std::shared_ptr<slots> EMPTY_SLOTS = std::make_shared<slots>(0, std::pmr::new_delete_resource());
+        return EMPTY_SLOTS;
+    }
+
+    /** Gives this table its own copy of its slots if they are shared, before they are modified. */
+    void detach() {
+        if (shared.use_count() != 1) {
+            shared = make_slots(shared->resource, *shared);
+        }
+        else {
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+    }
+
+    /** Gives this table its own copy of its slots if they are shared, and marks them unsharable before a mutable pointer or reference is returned. */
+    void borrow() {
+        detach();
+        shared->unsharable = true;
+    }
+
+    /** Gives this table its own copy of its slots if they are shared before they are modified, which ends any borrow so its copies share them again. */
+    void modify() {
+        detach();
+        shared->unsharable = false;
+    }
 
-    /** Default constructor. */
-    table(const size_t buckets = 16) : objects(buckets) {
+    /** Returns the given slots to share with a copy, or a copy of them if they are unsharable. */
+    static std::shared_ptr<slots> share(const std::shared_ptr<slots> &copied) {
+        return copied->unsharable ? make_slots(copied->resource, *copied) : copied;
     }
 
-    /** Copy constructor. */
-    table(const table &copied) : objects(copied.objects.bucket_count()) {
-        for (auto &pair : copied.objects) {
-            objects[pair.first] = pair.second->copy();
+    /** Returns the smallest power of two that is at least the given number of slots. */
+    static size_t round_capacity(const size_t minimum) {
+        size_t capacity = 8;
+        while (capacity < minimum) {
+            capacity *= 2;
         }
+        return capacity;
     }
 
-    /** Move constructor. */
-    table(table &&moved) noexcept : objects(std::move(moved.objects)) {
-        moved.objects.clear();
+    /** Returns the index of the slot with the given name and hash, or NOT_FOUND. */
+    size_t find_slot(const std::string_view name, const size_t hash) const noexcept {
+        if (shared->hashes.empty()) {
+            return NOT_FOUND;
+        }
+        const size_t mask = shared->hashes.size() - 1;
+        size_t index = hash & mask;
+        while (shared->hashes[index] != EMPTY) {
+            if (shared->hashes[index] == hash && shared->entries[index].first == name) {
+                return index;
+            }
+            index = (index + 1) & mask;
+        }
+        return NOT_FOUND;
+    }
+
+    /** Returns the index of the slot with the given name and hash, or claims an empty slot for it. */
+    size_t claim_slot(const std::string_view name, const size_t hash) {
+        modify();
+        if ((shared->count + 1) * 4 > shared->hashes.size() * 3) {
+            rehash(shared->hashes.size() * 2);
+        }
+        const size_t mask = shared->hashes.size() - 1;
+        size_t index = hash & mask;
+        while (shared->hashes[index] != EMPTY) {
+            if (shared->hashes[index] == hash && shared->entries[index].first == name) {
+                return index;
+            }
+            index = (index + 1) & mask;
+        }
+        shared->hashes[index] = hash;
+        shared->entries[index].first = name;
+        ++shared->count;
+        return index;
+    }
+
+    /** Empties the slot at the given index and shifts back any slots displaced past it. */
+    void erase_slot(size_t index) {
+        modify();
+        const size_t mask = shared->hashes.size() - 1;
+        size_t next = index;
+        while (true) {
+            next = (next + 1) & mask;
+            if (shared->hashes[next] == EMPTY) {
+                break;
+            }
+            const size_t home = shared->hashes[next] & mask;
+            if (((next - home) & mask) >= ((next - index) & mask)) {
+                shared->hashes[index] = shared->hashes[next];
+                shared->entries[index] = std::move(shared->entries[next]);
+                index = next;
+            }
+        }
+        shared->hashes[index] = EMPTY;
+        shared->entries[index].first.clear();
+        shared->entries[index].second.reset();
+        --shared->count;
     }
 
-    /** Destructor. */
-    ~table() {
-        for (auto &pair : objects) {
-            delete pair.second;
+    /** Moves every entry into a new set of slots. */
+    void rehash(const size_t capacity) {
+        std::pmr::vector<size_t> old_hashes(round_capacity(capacity), EMPTY, shared->resource);
+        std::pmr::vector<entry> old_entries(old_hashes.size(), shared->resource);
+        old_hashes.swap(shared->hashes);
+        old_entries.swap(shared->entries);
+        const size_t mask = shared->hashes.size() - 1;
+        for (size_t i = 0; i < old_hashes.size(); ++i) {
+            if (old_hashes[i] != EMPTY) {
+                size_t index = old_hashes[i] & mask;
+                while (shared->hashes[index] != EMPTY) {
+                    index = (index + 1) & mask;
+                }
+                shared->hashes[index] = old_hashes[i];
+                shared->entries[index] = std::move(old_entries[i]);
+            }
         }
     }
 
 
-    // OPERATORS
+    // JSON
 
-    /** Copy assignment operator. */
-    table &operator=(const table &copied) {
-        if (this != &copied) {
-            objects.clear();
-            for (auto &pair : copied.objects) {
-                objects[pair.first] = pair.second->copy();
+    /** Returns the first character at or after the given position that ends a JSON string run: a quote, a backslash, or a control character. */
+    static const char *scan_string(const char *cursor, const char *end) noexcept {
+#if TABLE_SSE2
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i control = _mm_set1_epi8(0x1F);
+        while (end - cursor >= 16) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cursor));
+            const __m128i found = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                                               _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control));
+            const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(found));
+            if (mask != 0) {
+#ifdef _MSC_VER
+                unsigned long index;
+                _BitScanForward(&index, mask);
+                return cursor + index;
+#else
+                return cursor + __builtin_ctz(mask);
+#endif
+            }
+            cursor += 16;
+        }
+#endif
+        while (cursor < end && *cursor != '"' && *cursor != '\\' && static_cast<unsigned char>(*cursor) > 0x1F) {
+            ++cursor;
+        }
+        return cursor;
+    }
+
+    /** Appends the given string to the given JSON buffer as an escaped, quoted JSON string. */
+    static void write_string(const std::string_view string, std::string &json) {
+        static const char HEX[] = "0123456789abcdef";
+        json += '"';
+        const char *cursor = string.data();
+        const char *end = cursor + string.size();
+        while (cursor < end) {
+            const char *run = scan_string(cursor, end);
+            json.append(cursor, run);
+            if (run == end) {
+                break;
+            }
+            switch (*run) {
+                case '"': json += "\\\""; break;
+                case '\\': json += "\\\\"; break;
+                case '\b': json += "\\b"; break;
+                case '\f': json += "\\f"; break;
+                case '\n': json += "\\n"; break;
+                case '\r': json += "\\r"; break;
+                case '\t': json += "\\t"; break;
+                default:
+                    json += "\\u00";
+                    json += HEX[static_cast<unsigned char>(*run) >> 4];
+                    json += HEX[static_cast<unsigned char>(*run) & 0xF];
+                    break;
+            }
+            cursor = run + 1;
+        }
+        json += '"';
+    }
+
+    /** Appends this table to the given JSON buffer, calling the given function after each entry so the buffer can be flushed. */
+    template <typename F>
+    void write_json(std::string &json, const bool pretty_print, F &&flush) const {
+        if (shared->count == 0) {
+            json += "{}";
+            return;
+        }
+        json += '{';
+        bool first = true;
+        for (auto &pair : *this) {
+            if (!first) {
+                json += ',';
+            }
+            first = false;
+            json += pretty_print ? "\n\t" : " ";
+            write_string(pair.first, json);
+            json += " : ";
+            pair.second.ops->write(pair.second.storage, json);
+            flush(json);
+        }
+        json += pretty_print ? "\n}" : " }";
+    }
+
+    /** A single pass JSON parser that reads a flat object into a table. */
+    class parser final {
+
+        // DATA
+
+        /** The next character to read. */
+        const char *cursor;
+
+        /** The end of the JSON. */
+        const char *end;
+
+        /** Reused storage for each parsed string. */
+        std::string buffer;
+
+
+        // PARSER
+
+        /** Throws an error for malformed JSON at the cursor. */
+        [[noreturn]] void fail(const char *message) const {
+            throw std::runtime_error(std::string("ERROR: Parsing table JSON failed (") + message + ") at: " + std::string(cursor, std::min<size_t>(end - cursor, 16)));
+        }
+
+        /** Skips any whitespace. */
+        void skip() noexcept {
+            while (cursor < end && (*cursor == ' ' || *cursor == '\n' || *cursor == '\t' || *cursor == '\r')) {
+                ++cursor;
+            }
+        }
+
+        /** Skips whitespace and then the given character. */
+        void expect(const char character) {
+            skip();
+            if (cursor >= end || *cursor != character) {
+                fail("unexpected character");
+            }
+            ++cursor;
+        }
+
+        /** Skips the given literal, returning whether it was present. */
+        bool literal(const std::string_view word) noexcept {
+            if (static_cast<size_t>(end - cursor) < word.size() || std::string_view(cursor, word.size()) != word) {
+                return false;
+            }
+            cursor += word.size();
+            return true;
+        }
+
+        /** Reads four hexadecimal digits. */
+        unsigned hex4() {
+            if (end - cursor < 4) {
+                fail("truncated unicode escape");
+            }
+            unsigned value = 0;
+            for (int i = 0; i < 4; ++i) {
+                const char digit = *cursor++;
+                value <<= 4;
+                if (digit >= '0' && digit <= '9') {
+                    value |= digit - '0';
+                }
+                else if (digit >= 'a' && digit <= 'f') {
+                    value |= digit - 'a' + 10;
+                }
+                else if (digit >= 'A' && digit <= 'F') {
+                    value |= digit - 'A' + 10;
+                }
+                else {
+                    fail("invalid unicode escape");
+                }
+            }
+            return value;
+        }
+
+        /** Appends the given code point to the buffer as UTF-8. */
+        void utf8(const unsigned code) {
+            if (code < 0x80) {
+                buffer += static_cast<char>(code);
+            }
+            else if (code < 0x800) {
+                buffer += static_cast<char>(0xC0 | code >> 6);
+                buffer += static_cast<char>(0x80 | (code & 0x3F));
+            }
+            else if (code < 0x10000) {
+                buffer += static_cast<char>(0xE0 | code >> 12);
+                buffer += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+                buffer += static_cast<char>(0x80 | (code & 0x3F));
+            }
+            else {
+                buffer += static_cast<char>(0xF0 | code >> 18);
+                buffer += static_cast<char>(0x80 | (code >> 12 & 0x3F));
+                buffer += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+                buffer += static_cast<char>(0x80 | (code & 0x3F));
+            }
+        }
+
+        /** Reads a quoted string into the buffer. */
+        void string() {
+            expect('"');
+            buffer.clear();
+            while (true) {
+                const char *run = scan_string(cursor, end);
+                buffer.append(cursor, run);
+                cursor = run;
+                if (cursor >= end) {
+                    fail("unterminated string");
+                }
+                if (*cursor == '"') {
+                    ++cursor;
+                    return;
+                }
+                if (*cursor != '\\') {
+                    fail("control character in string");
+                }
+                if (++cursor >= end) {
+                    fail("unterminated escape");
+                }
+                switch (*cursor++) {
+                    case '"': buffer += '"'; break;
+                    case '\\': buffer += '\\'; break;
+                    case '/': buffer += '/'; break;
+                    case 'b': buffer += '\b'; break;
+                    case 'f': buffer += '\f'; break;
+                    case 'n': buffer += '\n'; break;
+                    case 'r': buffer += '\r'; break;
+                    case 't': buffer += '\t'; break;
+                    case 'u': {
+                        unsigned code = hex4();
+                        if (code >= 0xD800 && code < 0xE000) {
+                            if (code >= 0xDC00 || end - cursor < 6 || cursor[0] != '\\' || cursor[1] != 'u') {
+                                fail("invalid surrogate pair");
+                            }
+                            cursor += 2;
+                            const unsigned low = hex4();
+                            if (low < 0xDC00 || low >= 0xE000) {
+                                fail("invalid surrogate pair");
+                            }
+                            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        }
+                        utf8(code);
+                        break;
+                    }
+                    default:
+                        fail("invalid escape");
+                }
+            }
+        }
+
+        /** Skips a run of digits and returns whether there was at least one. */
+        bool digits() noexcept {
+            const char *start = cursor;
+            while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+                ++cursor;
             }
+            return cursor != start;
         }
+
+        /** Reads a number in JSON's grammar (no leading zeros, '+' signs, or bare '.'s) and inserts it as an int, a long long, or a double. */
+        void number(table &result, const std::string &name) {
+            const char *start = cursor;
+            bool integer = true;
+            if (cursor < end && *cursor == '-') {
+                ++cursor;
+            }
+            if (cursor < end && *cursor == '0') {
+                ++cursor;
+            }
+            else if (!digits()) {
+                cursor = start;
+                fail("invalid number");
+            }
+            if (cursor < end && *cursor == '.') {
+                integer = false;
+                ++cursor;
+                if (!digits()) {
+                    cursor = start;
+                    fail("invalid number");
+                }
+            }
+            if (cursor < end && (*cursor == 'e' || *cursor == 'E')) {
+                integer = false;
+                ++cursor;
+                if (cursor < end && (*cursor == '+' || *cursor == '-')) {
+                    ++cursor;
+                }
+                if (!digits()) {
+                    cursor = start;
+                    fail("invalid number");
+                }
+            }
+            if (cursor < end && ((*cursor >= '0' && *cursor <= '9') || *cursor == '.' || *cursor == '+' || *cursor == '-')) {
+                cursor = start;
+                fail("invalid number");
+            }
+            if (integer) {
+                long long value = 0;
+                const std::from_chars_result parsed = std::from_chars(start, cursor, value);
+                if (parsed.ec == std::errc() && parsed.ptr == cursor) {
+                    if (value >= std::numeric_limits<int>::min() && value <= std::numeric_limits<int>::max()) {
+                        result.assign<int>(name, static_cast<int>(value));
+                    }
+                    else {
+                        result.assign<long long>(name, value);
+                    }
+                    return;
+                }
+            }
+#if TABLE_FLOAT_CHARCONV
+            double value = 0;
+            const std::from_chars_result parsed = std::from_chars(start, cursor, value);
+            if (parsed.ec != std::errc() || parsed.ptr != cursor) {
+                cursor = start;
+                fail("invalid number");
+            }
+#else
+            const std::string text(start, cursor);
+            char *parsed = nullptr;
+            const double value = std::strtod(text.c_str(), &parsed);
+            if (parsed != text.c_str() + text.size() || !std::isfinite(value)) {
+                cursor = start;
+                fail("invalid number");
+            }
+#endif
+            result.assign<double>(name, value);
+        }
+
+    public:
+
+        // CONSTRUCTOR
+
+        /** Creates a parser of the given JSON. */
+        explicit parser(const std::string_view json) : cursor(json.data()), end(json.data() + json.size()), buffer() {
+        }
+
+
+        // PARSER
+
+        /** Parses a flat JSON object of strings, numbers, booleans, and nulls into the given table. */
+        void parse(table &result) {
+            expect('{');
+            skip();
+            if (cursor < end && *cursor == '}') {
+                ++cursor;
+            }
+            else {
+                std::string name;
+                while (true) {
+                    string();
+                    name.swap(buffer);
+                    expect(':');
+                    skip();
+                    if (cursor >= end) {
+                        fail("missing value");
+                    }
+                    const char character = *cursor;
+                    if (character == '"') {
+                        string();
+                        result.assign<std::string>(name, buffer);
+                    }
+                    else if (character == '-' || (character >= '0' && character <= '9')) {
+                        number(result, name);
+                    }
+                    else if (literal("true")) {
+                        result.assign<bool>(name, true);
+                    }
+                    else if (literal("false")) {
+                        result.assign<bool>(name, false);
+                    }
+                    else if (literal("null")) {
+                        result.erase(name);
+                    }
+                    else {
+                        fail("unsupported value (nested objects and arrays are not supported)");
+                    }
+                    skip();
+                    if (cursor < end && *cursor == ',') {
+                        ++cursor;
+                        continue;
+                    }
+                    expect('}');
+                    break;
+                }
+            }
+            skip();
+            if (cursor != end) {
+                fail("trailing characters");
+            }
+        }
+    };
+
+    /** Constructs a new object with the given name and type, replacing any existing object of that name regardless of its type. */
+    template <typename T, typename... A>
+    void assign(const std::string_view name, A &&...args) {
+        const key hashed(name);
+        const size_t index = find_slot(hashed.name, hashed.hash);
+        if (index != NOT_FOUND && !shared->entries[index].second.is<T>()) {
+            erase_slot(index);
+        }
+        store<T>(hashed, std::forward<A>(args)...);
+    }
+
+    /** Constructs a new object with the given key and type, and returns the index of its slot. */
+    template <typename T, typename... A>
+    size_t store(const key &name, A &&...args) {
+        size_t index = find_slot(name.name, name.hash);
+        if (index != NOT_FOUND && !shared->entries[index].second.is<T>()) {
+            throw std::runtime_error(std::string("ERROR: Overwriting table object of name ") + std::string(name.name) + " and type " + shared->entries[index].second.type().name() + " with a new object of type " + typeid(T).name() + '!');
+        }
+        object value;
+        value.emplace<T>(shared->resource, std::forward<A>(args)...);
+        if (index == NOT_FOUND) {
+            index = claim_slot(name.name, name.hash);
+        }
+        else {
+            modify();
+        }
+        shared->entries[index].second = std::move(value);
+        return index;
+    }
+
+
+    // BINARY
+
+    /** The first four bytes of the binary format. */
+    static constexpr char BINARY_MAGIC[4] = {'F', 'T', 'B', 'L'};
+
+    /** The version of the binary format. */
+    static constexpr uint32_t BINARY_VERSION = 1;
+
+    /** The size in bytes of the binary format's header. */
+    static constexpr size_t BINARY_HEADER = 32;
+
+    /** The size in bytes of each entry in the binary format. */
+    static constexpr size_t BINARY_ENTRY = 32;
+
+    /** Hashes the given name with 64-bit FNV-1a, which is stable across processes. */
+    static uint64_t binary_hash(const std::string_view name) noexcept {
+        uint64_t result = 14695981039346656037ull;
+        for (const char character : name) {
+            result ^= static_cast<unsigned char>(character);
+            result *= 1099511628211ull;
+        }
+        return result;
+    }
+
+    /** Writes the given integer in little-endian order at the given position. */
+    template <typename U>
+    static void binary_put(unsigned char *bytes, U value) noexcept {
+        for (size_t i = 0; i < sizeof(U); ++i) {
+            bytes[i] = static_cast<unsigned char>(value >> (i * 8));
+        }
+    }
+
+    /** Reads an integer in little-endian order from the given position. */
+    template <typename U>
+    static U binary_get(const unsigned char *bytes) noexcept {
+        U value = 0;
+        for (size_t i = 0; i < sizeof(U); ++i) {
+            value |= static_cast<U>(bytes[i]) << (i * 8);
+        }
+        return value;
+    }
+
+public:
+
+    // CONSTRUCTORS
+
+    /**
+     * Default constructor. The table's slots, and its objects that are not stored inline, are allocated from the given memory resource,
+     * such as a std::pmr::monotonic_buffer_resource for a short-lived table. The resource must outlive every copy of the table.
+     */
+    table(const size_t buckets = 16, std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : shared(make_slots(resource, round_capacity(buckets), resource)) {
+    }
+
+    /** Copy constructor. Shares the copied table's objects in O(1) until either table is modified, unless it has returned a mutable pointer or reference. */
+    table(const table &copied) : shared(share(copied.shared)) {
+    }
+
+    /** Move constructor. */
+    table(table &&moved) noexcept : shared(std::move(moved.shared)) {
+        moved.shared = empty();
+    }
+
+
+    // OPERATORS
+
+    /** Copy assignment operator. Shares the copied table's objects in O(1) until either table is modified, unless it has returned a mutable pointer or reference. */
+    table &operator=(const table &copied) {
+        shared = share(copied.shared);
         return *this;
     }
 
     /** Move assignment operator. */
     table &operator=(table &&moved) noexcept {
         if (this != &moved) {
-            for (auto &pair : objects) {
-                delete pair.second;
-            }
-            objects = std::move(moved.objects);
-            moved.objects.clear();
+            shared = std::move(moved.shared);
+            moved.shared = empty();
         }
         return *this;
     }
 
-    /** Returns a reference to an object with the given name. */
-    object &operator[](const std::string &name) {
-        if (!objects.count(name)) {
-            throw std::runtime_error(std::string("ERROR: Object of name ") + name + " was not found in the table!");
+    /** Returns a reference to an object with the given key. Gives this table its own copy of its objects if they are shared, and stops sharing them with later copies. */
+    object &operator[](const key &name) {
+        const size_t index = find_slot(name.name, name.hash);
+        if (index == NOT_FOUND) {
+            throw std::runtime_error(std::string("ERROR: Object of name ") + std::string(name.name) + " was not found in the table!");
         }
-        return *objects.at(name);
+        borrow();
+        return shared->entries[index].second;
     }
 
-    /** Returns a reference to an object with the given name. */
-    const object &operator[](const std::string &name) const {
-        if (!objects.count(name)) {
-            throw std::runtime_error(std::string("ERROR: Object of name ") + name + " was not found in the table!");
+    /** Returns a reference to an object with the given key. */
+    const object &operator[](const key &name) const {
+        const size_t index = find_slot(name.name, name.hash);
+        if (index == NOT_FOUND) {
+            throw std::runtime_error(std::string("ERROR: Object of name ") + std::string(name.name) + " was not found in the table!");
         }
-        return *objects.at(name);
+        return shared->entries[index].second;
+    }
+
+    /** Returns a reference to an object with the given name. */
+    object &operator[](const std::string_view name) {
+        return (*this)[key(name)];
+    }
+
+    /** Returns a reference to an object with the given name. */
+    const object &operator[](const std::string_view name) const {
+        return (*this)[key(name)];
     }
 
 
     // TABLE
 
+    /** Returns a key for the given name whose characters are stored for the lifetime of the program. Thread safe. */
+    static key intern(const std::string_view name) {
+        static std::mutex lock;
+        static std::unordered_set<std::string_view> names;
+        static std::deque<std::string> storage;
+        std::lock_guard<std::mutex> guard(lock);
+        auto found = names.find(name);
+        if (found != names.end()) {
+            return key(*found);
+        }
+        storage.emplace_back(name);
+        names.insert(storage.back());
+        return key(storage.back());
+    }
+
     /** Returns an iterator to the beginning of the table. */
-    std::unordered_map<std::string, object *>::const_iterator begin() const {
-        return objects.begin();
+    const_iterator begin() const {
+        return const_iterator(this, 0);
     }
 
     /** Returns an iterator to the end of the table. */
-    std::unordered_map<std::string, object *>::const_iterator end() const {
-        return objects.end();
+    const_iterator end() const {
+        return const_iterator(this, shared->hashes.size());
     }
 
     /** Returns the current number of stored objects. */
     size_t size() const {
-        return objects.size();
+        return shared->count;
     }
 
-    /** Returns the current number of buckets. */
+    /** Returns the current number of slots. */
     size_t buckets() const {
-        return objects.bucket_count();
+        return shared->hashes.size();
     }
 
-    /** Returns a pointer to the object with the given name and type (or nullptr). */
+    /** Returns the memory resource this table allocates from. */
+    std::pmr::memory_resource *resource() const noexcept {
+        return shared->resource;
+    }
+
+    /** Returns the type ID of the given type. */
     template <typename T>
-    T *find(const std::string &name) {
-        try {
-            if (objects.count(name)) {
-                return &(objects.at(name)->as<T>());
-            }
-            return nullptr;
-        }
-        catch (const std::exception &e) {
+    static type_id id_of() noexcept {
+        return reinterpret_cast<type_id>(&handler<std::remove_cv_t<T>>::OPERATIONS);
+    }
+
+    /** Returns a pointer to the object with the given key and type (or nullptr). Gives this table its own copy of its objects if they are shared, and stops sharing them with later copies. */
+    template <typename T>
+    T *find(const key &name) {
+        const size_t index = find_slot(name.name, name.hash);
+        if (index == NOT_FOUND || !shared->entries[index].second.is<T>()) {
             return nullptr;
         }
+        borrow();
+        return shared->entries[index].second.get_if<T>();
+    }
+
+    /** Returns a pointer to the object with the given key and type (or nullptr). */
+    template <typename T>
+    const T *find(const key &name) const noexcept {
+        const size_t index = find_slot(name.name, name.hash);
+        return index != NOT_FOUND ? shared->entries[index].second.get_if<T>() : nullptr;
+    }
+
+    /** Returns a pointer to the object with the given name and type (or nullptr). Gives this table its own copy of its objects if they are shared, and stops sharing them with later copies. */
+    template <typename T>
+    T *find(const std::string_view name) {
+        return find<T>(key(name));
     }
 
     /** Returns a pointer to the object with the given name and type (or nullptr). */
     template <typename T>
-    const T *find(const std::string &name) const {
-        try {
-            if (objects.count(name)) {
-                return &(objects.at(name)->as<T>());
-            }
-            return nullptr;
-        }
-        catch (const std::exception &e) {
-            return nullptr;
+    const T *find(const std::string_view name) const noexcept {
+        return find<T>(key(name));
+    }
+
+    /** Copies the object with the given key and type into the given output and returns whether it was found. */
+    template <typename T>
+    bool try_get(const key &name, T &out) const {
+        const T *data = find<T>(name);
+        if (data == nullptr) {
+            return false;
         }
+        out = *data;
+        return true;
+    }
+
+    /** Copies the object with the given name and type into the given output and returns whether it was found. */
+    template <typename T>
+    bool try_get(const std::string_view name, T &out) const {
+        return try_get<T>(key(name), out);
+    }
+
+    /** Returns the type ID of the object with the given key, or NO_TYPE if it was not found. */
+    type_id id_of(const key &name) const noexcept {
+        const size_t index = find_slot(name.name, name.hash);
+        return index != NOT_FOUND ? shared->entries[index].second.id() : NO_TYPE;
+    }
+
+    /** Returns the type ID of the object with the given name, or NO_TYPE if it was not found. */
+    type_id id_of(const std::string_view name) const noexcept {
+        return id_of(key(name));
+    }
+
+    /** Returns whether the table contains an object of the given key. */
+    bool contains(const key &name) const noexcept {
+        return find_slot(name.name, name.hash) != NOT_FOUND;
     }
 
     /** Returns whether the table contains an object of the given name. */
-    bool contains(const std::string &name) const {
-        return objects.count(name);
+    bool contains(const std::string_view name) const noexcept {
+        return contains(key(name));
+    }
+
+    /** Returns whether the table contains an object of the given key and type. */
+    template <typename T>
+    bool contains(const key &name) const noexcept {
+        const size_t index = find_slot(name.name, name.hash);
+        return index != NOT_FOUND && shared->entries[index].second.is<T>();
     }
 
     /** Returns whether the table contains an object of the given name and type. */
     template <typename T>
-    bool contains(const std::string &name) const {
-        return objects.count(name) && objects.at(name)->is<T>();
+    bool contains(const std::string_view name) const noexcept {
+        return contains<T>(key(name));
+    }
+
+    /** Constructs a new object with the given key and type. Copies of this table no longer share its objects while the returned reference is usable. */
+    template <typename T, typename... A>
+    T &insert(const key &name, A &&...args) {
+        const size_t index = store<T>(name, std::forward<A>(args)...);
+        shared->unsharable = true;
+        return *handler<T>::get(shared->entries[index].second.storage);
     }
 
     /** Constructs a new object with the given name and type. */
     template <typename T, typename... A>
-    T &insert(const std::string &name, A &&...args) {
-        if (objects.count(name)) {
-            if (!objects[name]->is<T>()) {
-                throw std::runtime_error(std::string("ERROR: Overwriting table object of name ") + name + " and type " + objects[name]->type().name() + " with a new object of type " + typeid(T).name() + '!');
-            }
-            delete objects[name];
-        }
-        objects[name] = new templated_object<T>(std::forward<A>(args)...);
-        return objects[name]->as<T>();
+    T &insert(const std::string_view name, A &&...args) {
+        return insert<T>(key(name), std::forward<A>(args)...);
     }
 
-    /** Erases the object with the given name. */
-    bool erase(const std::string &name) {
-        if (!objects.count(name)) {
+    /** Constructs a new object with the given key and type without returning it, so copies of this table can still share its objects. */
+    template <typename T, typename... A>
+    void set(const key &name, A &&...args) {
+        store<T>(name, std::forward<A>(args)...);
+    }
+
+    /** Constructs a new object with the given name and type without returning it, so copies of this table can still share its objects. */
+    template <typename T, typename... A>
+    void set(const std::string_view name, A &&...args) {
+        set<T>(key(name), std::forward<A>(args)...);
+    }
+
+    /** Erases the object with the given key. */
+    bool erase(const key &name) {
+        const size_t index = find_slot(name.name, name.hash);
+        if (index == NOT_FOUND) {
             return false;
         }
-        delete objects[name];
-        objects.erase(name);
+        erase_slot(index);
         return true;
     }
 
+    /** Erases the object with the given name. */
+    bool erase(const std::string_view name) {
+        return erase(key(name));
+    }
+
     /** Clears the table of all its objects. */
     void clear() {
-        for (auto &pair : objects) {
-            delete pair.second;
+        if (shared.use_count() != 1) {
+            shared = make_slots(shared->resource, shared->hashes.size(), shared->resource);
+            return;
+        }
+        for (size_t i = 0; i < shared->hashes.size(); ++i) {
+            if (shared->hashes[i] != EMPTY) {
+                shared->hashes[i] = EMPTY;
+                shared->entries[i].first.clear();
+                shared->entries[i].second.reset();
+            }
         }
-        objects.clear();
+        shared->count = 0;
+        shared->unsharable = false;
+    }
+
+    /** Appends this table to the given buffer as JSON. */
+    void to_json(std::string &json, const bool pretty_print = true) const {
+        write_json(json, pretty_print, [](std::string &) {
+        });
+    }
+
+    /** Writes this table to the given stream as JSON, flushing every few kilobytes. */
+    void to_json(std::ostream &stream, const bool pretty_print = true) const {
+        std::string json;
+        json.reserve(8192);
+        write_json(json, pretty_print, [&stream](std::string &buffer) {
+            if (buffer.size() >= 4096) {
+                stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                buffer.clear();
+            }
+        });
+        stream.write(json.data(), static_cast<std::streamsize>(json.size()));
     }
 
     /** Converts this table into a string. */
     std::string to_string(const bool pretty_print = true) const {
-        if (objects.size() == 0) {
-            return "{}";
+        std::string json;
+        json.reserve(shared->count * 32 + 4);
+        to_json(json, pretty_print);
+        return json;
+    }
+
+    /**
+     * Parses a flat JSON object into a new table.<br/>
+     * Strings become std::string, integers become int (or long long if out of range), other numbers become double,
+     * booleans become bool, and nulls are skipped. Throws on malformed JSON, nested objects, or arrays.
+     */
+    static table from_json(const std::string_view json, std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+        table result(16, resource);
+        parser(json).parse(result);
+        return result;
+    }
+
+    /**
+     * Replaces the given buffer with this table in the binary format, which table_view can read without parsing.<br/>
+     * Layout (little-endian): a 32 byte header, an open-addressed index of 32-bit entry numbers by FNV-1a hash,
+     * 32 byte entries of {hash, key offset, key size, type tag, value}, then a dictionary of key and string bytes.<br/>
+     * Throws if an object's type has no binary type tag.
+     */
+    void to_binary(std::string &bytes) const {
+        size_t index_size = 1;
+        while (index_size < shared->count * 2) {
+            index_size *= 2;
         }
-        std::string json("{");
-        if (pretty_print) {
-            for (auto &pair : objects) {
-                json += "\n\t\"" + pair.first + "\" : " + ((pair.second->is<std::string>()) ? ('"' + pair.second->to_string() + '"') : (pair.second->to_string())) + ',';
+        const size_t entries_offset = (BINARY_HEADER + index_size * 4 + 7) / 8 * 8;
+        size_t dictionary_size = 0;
+        for (auto &pair : *this) {
+            if (pair.second.ops->binary == binary_type::NONE) {
+                throw std::runtime_error(std::string("ERROR: Table object of name ") + pair.first + " and type " + pair.second.type().name() + " has no binary format!");
+            }
+            dictionary_size += pair.first.size();
+            if (pair.second.ops->binary == binary_type::STRING) {
+                dictionary_size += pair.second.as<std::string>().size();
             }
-            json = json.erase(json.length() - 1, 1);
-            json += '\n';
         }
-        else {
-            for (auto &pair : objects)
-            {
-                json += " \"" + pair.first + "\" : " + ((pair.second->is<std::string>()) ? ('"' + pair.second->to_string() + '"') : (pair.second->to_string())) + ',';
+        size_t dictionary = entries_offset + shared->count * BINARY_ENTRY;
+        const size_t total = dictionary + dictionary_size;
+        if (total > UINT32_MAX) {
+            throw std::runtime_error("ERROR: Table is too large for the binary format!");
+        }
+        bytes.assign(total, '\0');
+        unsigned char *data = reinterpret_cast<unsigned char *>(&bytes[0]);
+        std::memcpy(data, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+        binary_put<uint32_t>(data + 4, BINARY_VERSION);
+        binary_put<uint32_t>(data + 8, static_cast<uint32_t>(shared->count));
+        binary_put<uint32_t>(data + 12, static_cast<uint32_t>(index_size));
+        binary_put<uint64_t>(data + 16, total);
+        uint32_t number = 0;
+        for (auto &pair : *this) {
+            const uint64_t hashed = binary_hash(pair.first);
+            size_t slot = hashed & (index_size - 1);
+            while (binary_get<uint32_t>(data + BINARY_HEADER + slot * 4) != 0) {
+                slot = (slot + 1) & (index_size - 1);
+            }
+            binary_put<uint32_t>(data + BINARY_HEADER + slot * 4, number + 1);
+            unsigned char *entry = data + entries_offset + number * BINARY_ENTRY;
+            binary_put<uint64_t>(entry, hashed);
+            binary_put<uint32_t>(entry + 8, static_cast<uint32_t>(dictionary));
+            binary_put<uint32_t>(entry + 12, static_cast<uint32_t>(pair.first.size()));
+            std::memcpy(data + dictionary, pair.first.data(), pair.first.size());
+            dictionary += pair.first.size();
+            entry[16] = static_cast<unsigned char>(pair.second.ops->binary);
+            if (pair.second.ops->binary == binary_type::STRING) {
+                const std::string &string = pair.second.as<std::string>();
+                binary_put<uint32_t>(entry + 24, static_cast<uint32_t>(dictionary));
+                binary_put<uint32_t>(entry + 28, static_cast<uint32_t>(string.size()));
+                std::memcpy(data + dictionary, string.data(), string.size());
+                dictionary += string.size();
             }
-            json = json.erase(json.length() - 1, 1);
-            json += ' ';
+            else {
+                binary_put<uint64_t>(entry + 24, pair.second.ops->bits(pair.second.storage));
+            }
+            ++number;
         }
-        return json + '}';
+    }
+
+    /** Returns this table in the binary format. */
+    std::string to_binary() const {
+        std::string bytes;
+        to_binary(bytes);
+        return bytes;
     }
 };
@@ -0,0 +1,256 @@
+// .cpp
+// Table Benchmark
+// by Kyle Furey
+
+// Measures the speed of table lookups that hit, miss, or find an object of another type, of JSON round trips,
+// and of short-lived tables allocating from the default resource and from an arena.
+// Build with optimizations, such as: c++ -std=c++17 -O2 table_benchmark.cpp
+
+#include "table.hpp"
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+/** The number of objects in each benchmarked table. */
+#define BENCHMARK_KEYS 1024
+
+/** The number of times each lookup is run over every key. */
+#define BENCHMARK_RUNS 2000
+
+/** The number of objects in the table written to and parsed from JSON. */
+#define BENCHMARK_JSON_KEYS 100000
+
+/** The number of times the JSON table is written and parsed. */
+#define BENCHMARK_JSON_RUNS 10
+
+/** The number of objects in each table that is created, populated, and destroyed. */
+#define BENCHMARK_CYCLE_KEYS 64
+
+/** The number of tables that are created, populated, and destroyed. */
+#define BENCHMARK_CYCLES 100000
+
+/** Stores the results of each run so they are not optimized away. */
+static volatile double benchmark_sink;
+
+
+// BENCHMARK
+
+/** Returns the current time. */
+static std::chrono::steady_clock::time_point benchmark_now() {
+    return std::chrono::steady_clock::now();
+}
+
+/** Prints the nanoseconds per operation of a benchmark of the given number of operations that started at the given time. */
+static void benchmark_report(const char *name, const std::chrono::steady_clock::time_point start, const double operations) {
+    const double elapsed = std::chrono::duration<double>(benchmark_now() - start).count();
+    std::printf("%-40s %8.3f ns/op\n", name, elapsed * 1e9 / operations);
+}
+
+/** Runs the given expression for every index i of BENCHMARK_KEYS keys BENCHMARK_RUNS times, adds each result to the sink, and reports its speed. */
+#define BENCHMARK_LOOKUP(name, expression)\
+    do {\
+        const auto start = benchmark_now();\
+        for (int run = 0; run < BENCHMARK_RUNS; ++run) {\
+            for (size_t i = 0; i < BENCHMARK_KEYS; ++i) {\
+                benchmark_sink = benchmark_sink + static_cast<double>(expression);\
+            }\
+        }\
+        benchmark_report(name, start, static_cast<double>(BENCHMARK_KEYS) * BENCHMARK_RUNS);\
+    } while (0)
+
+/** Returns the given number of distinct names that start with the given prefix. */
+static std::vector<std::string> benchmark_names(const char *prefix, const size_t count) {
+    std::vector<std::string> names;
+    for (size_t i = 0; i < count; ++i) {
+        names.push_back(prefix + std::to_string(i));
+    }
+    return names;
+}
+
+/** Returns a key for each of the given names. */
+static std::vector<table::key> benchmark_keys(const std::vector<std::string> &names) {
+    std::vector<table::key> keys;
+    for (const std::string &name : names) {
+        keys.emplace_back(name);
+    }
+    return keys;
+}
+
+/** Returns the value of the given int if it was found, or -1. */
+static int benchmark_value(const int *found) {
+    return found != nullptr ? *found : -1;
+}
+
+
+// LOOKUPS
+
+/** Benchmarks find<T>() and try_get<T>() on objects that exist, objects of another type, and objects that do not exist. */
+static void benchmark_lookups() {
+    const std::vector<std::string> names = benchmark_names("object", BENCHMARK_KEYS);
+    const std::vector<std::string> missing_names = benchmark_names("missing", BENCHMARK_KEYS);
+    const std::vector<table::key> keys = benchmark_keys(names);
+    const std::vector<table::key> missing = benchmark_keys(missing_names);
+    table objects;
+    for (size_t i = 0; i < BENCHMARK_KEYS; ++i) {
+        objects.set<int>(keys[i], static_cast<int>(i));
+    }
+    const table &data = objects;
+
+    std::printf("Lookups, %d objects, %d runs\n\n", BENCHMARK_KEYS, BENCHMARK_RUNS);
+
+    BENCHMARK_LOOKUP("find<int> hit (key)", benchmark_value(data.find<int>(keys[i])));
+    BENCHMARK_LOOKUP("find<int> hit (name)", benchmark_value(data.find<int>(names[i])));
+    BENCHMARK_LOOKUP("find<float> mismatch (key)", data.find<float>(keys[i]) != nullptr);
+    BENCHMARK_LOOKUP("find<float> mismatch (name)", data.find<float>(names[i]) != nullptr);
+    BENCHMARK_LOOKUP("find<int> missing (key)", data.find<int>(missing[i]) != nullptr);
+    BENCHMARK_LOOKUP("find<int> missing (name)", data.find<int>(missing_names[i]) != nullptr);
+    std::printf("\n");
+
+    int value = 0;
+    float other = 0;
+    BENCHMARK_LOOKUP("try_get<int> hit (key)", data.try_get<int>(keys[i], value) ? value : -1);
+    BENCHMARK_LOOKUP("try_get<float> mismatch (key)", data.try_get<float>(keys[i], other));
+    BENCHMARK_LOOKUP("try_get<int> missing (key)", data.try_get<int>(missing[i], value));
+    std::printf("\n");
+}
+
+
+// JSON
+
+/** Prints the milliseconds per run and the megabytes per second of a benchmark of the given number of bytes per run that started at the given time. */
+static void benchmark_report_json(const char *name, const std::chrono::steady_clock::time_point start, const size_t bytes) {
+    const double elapsed = std::chrono::duration<double>(benchmark_now() - start).count() / BENCHMARK_JSON_RUNS;
+    std::printf("%-40s %8.3f ms %9.1f MB/s\n", name, elapsed * 1e3, bytes / elapsed / 1e6);
+}
+
+/** Benchmarks writing a table of strings, ints, doubles, and bools to JSON and parsing it back. Returns whether the parsed table matches. */
+static bool benchmark_json() {
+    table objects;
+    for (int i = 0; i < BENCHMARK_JSON_KEYS; ++i) {
+        const std::string name = "object" + std::to_string(i);
+        switch (i % 4) {
+            case 0:
+                objects.set<std::string>(name, "value \"" + std::to_string(i) + "\"\n");
+                break;
+            case 1:
+                objects.set<int>(name, i * 31 - 1000000);
+                break;
+            case 2:
+                objects.set<double>(name, i / 7.0);
+                break;
+            default:
+                objects.set<bool>(name, i % 8 == 3);
+                break;
+        }
+    }
+
+    std::printf("JSON, %d objects, %d runs\n\n", BENCHMARK_JSON_KEYS, BENCHMARK_JSON_RUNS);
+
+    std::string json;
+    auto start = benchmark_now();
+    for (int run = 0; run < BENCHMARK_JSON_RUNS; ++run) {
+        json.clear();
+        objects.to_json(json, false);
+    }
+    benchmark_report_json("to_json (reused buffer)", start, json.size());
+
+    start = benchmark_now();
+    for (int run = 0; run < BENCHMARK_JSON_RUNS; ++run) {
+        std::ostringstream stream;
+        objects.to_json(stream, false);
+        benchmark_sink = benchmark_sink + static_cast<double>(stream.tellp());
+    }
+    benchmark_report_json("to_json (stream)", start, json.size());
+
+    start = benchmark_now();
+    for (int run = 0; run < BENCHMARK_JSON_RUNS; ++run) {
+        benchmark_sink = benchmark_sink + static_cast<double>(table::from_json(json).size());
+    }
+    benchmark_report_json("from_json", start, json.size());
+
+    std::string pretty;
+    objects.to_json(pretty, true);
+    start = benchmark_now();
+    for (int run = 0; run < BENCHMARK_JSON_RUNS; ++run) {
+        benchmark_sink = benchmark_sink + static_cast<double>(table::from_json(pretty).size());
+    }
+    benchmark_report_json("from_json (pretty printed)", start, pretty.size());
+
+    const table parsed = table::from_json(json);
+    std::string round_trip;
+    parsed.to_json(round_trip, false);
+    if (parsed.size() != objects.size() || round_trip.size() != json.size() || *parsed.find<std::string>("object4") != *objects.find<std::string>("object4")) {
+        std::printf("ERROR: The parsed table does not match the written table!\n");
+        return false;
+    }
+    std::printf("\n");
+    return true;
+}
+
+
+// RESOURCES
+
+/** Creates a table that allocates from the given resource, populates it with ints, doubles, and strings, and returns its size as it is destroyed. */
+static size_t benchmark_cycle(const std::vector<table::key> &keys, std::pmr::memory_resource *resource) {
+    table objects(16, resource);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        switch (i % 3) {
+            case 0:
+                objects.set<int>(keys[i], static_cast<int>(i));
+                break;
+            case 1:
+                objects.set<double>(keys[i], i * 0.5);
+                break;
+            default:
+                objects.set<std::string>(keys[i], "value");
+                break;
+        }
+    }
+    return objects.size();
+}
+
+/** Benchmarks creating, populating, and destroying tables that allocate from the default resource and from a monotonic_buffer_resource. */
+static void benchmark_resources() {
+    const std::vector<std::string> names = benchmark_names("request_scoped_field_", BENCHMARK_CYCLE_KEYS);
+    const std::vector<table::key> keys = benchmark_keys(names);
+
+    std::printf("Create, populate, and destroy, %d objects, %d cycles\n\n", BENCHMARK_CYCLE_KEYS, BENCHMARK_CYCLES);
+
+    auto start = benchmark_now();
+    for (int cycle = 0; cycle < BENCHMARK_CYCLES; ++cycle) {
+        benchmark_sink = benchmark_sink + static_cast<double>(benchmark_cycle(keys, std::pmr::get_default_resource()));
+    }
+    benchmark_report("default resource", start, BENCHMARK_CYCLES);
+
+    static std::byte buffer[1 << 16];
+    start = benchmark_now();
+    for (int cycle = 0; cycle < BENCHMARK_CYCLES; ++cycle) {
+        std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer));
+        benchmark_sink = benchmark_sink + static_cast<double>(benchmark_cycle(keys, &arena));
+    }
+    benchmark_report("monotonic_buffer_resource", start, BENCHMARK_CYCLES);
+
+    std::pmr::unsynchronized_pool_resource pool;
+    start = benchmark_now();
+    for (int cycle = 0; cycle < BENCHMARK_CYCLES; ++cycle) {
+        benchmark_sink = benchmark_sink + static_cast<double>(benchmark_cycle(keys, &pool));
+    }
+    benchmark_report("unsynchronized_pool_resource", start, BENCHMARK_CYCLES);
+    std::printf("\n");
+}
+
+
+// MAIN
+
+/** Entry point of the program. */
+int main() {
+    benchmark_lookups();
+    benchmark_resources();
+    if (!benchmark_json()) {
+        return 1;
+    }
+    return 0;
+}
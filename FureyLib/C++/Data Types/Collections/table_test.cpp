@@ -0,0 +1,121 @@
+// .cpp
+// Table Tests
+// by Kyle Furey
+
+#include "table.hpp"
+#include <cassert>
+#include <cstdio>
+
+
+// TESTS
+
+/** Tests that a reference returned before a table is copied never modifies the copy. */
+static void test_snapshot_after_borrow() {
+    table t;
+    int &hp = t.insert<int>("hp", 1);
+    table snapshot = t;
+    hp = 99;
+    assert(*snapshot.find<int>("hp") == 1);
+    assert(*t.find<int>("hp") == 99);
+
+    int *mp = t.find<int>("hp");
+    table assigned;
+    assigned = t;
+    *mp = 7;
+    assert(*static_cast<const table &>(assigned).find<int>("hp") == 99);
+}
+
+/** Tests that copies of a table filled with set() share their objects until one of them is modified. */
+static void test_snapshot_without_borrow() {
+    table t;
+    t.insert<int>("hp", 1);
+    t.clear();
+    t.set<int>("mp", 2);
+    const table snapshot = t;
+    const table &original = t;
+    assert(snapshot.find<int>("mp") == original.find<int>("mp"));
+    t.set<int>("mp", 3);
+    assert(*snapshot.find<int>("mp") == 2);
+    assert(*original.find<int>("mp") == 3);
+}
+
+/** Tests that a table read through a mutable pointer shares its objects with copies again once it is next modified. */
+static void test_snapshot_after_modify() {
+    table t;
+    t.set<int>("hp", 1);
+    t.set<int>("mp", 2);
+    *t.find<int>("hp") = 5;
+    const table deep = t;
+    const table &original = t;
+    assert(deep.find<int>("mp") != original.find<int>("mp"));
+    t.set<int>("mp", 3);
+    const table first = t;
+    const table second = t;
+    assert(first.find<int>("hp") == original.find<int>("hp"));
+    assert(second.find<int>("mp") == original.find<int>("mp"));
+    assert(*first.find<int>("hp") == 5);
+    t.erase("hp");
+    assert(*first.find<int>("hp") == 5);
+    assert(*deep.find<int>("mp") == 2);
+}
+
+/** Tests that tables loaded from JSON can still be snapshotted in O(1). */
+static void test_snapshot_from_json() {
+    const table loaded = table::from_json(R"({"hp": 10, "name": "furey"})");
+    const table snapshot = loaded;
+    assert(snapshot.find<int>("hp") == loaded.find<int>("hp"));
+    assert(*snapshot.find<std::string>("name") == "furey");
+}
+
+/** Tests that numbers outside of JSON's grammar are rejected and numbers inside it keep their type and value. */
+static void test_json_numbers() {
+    for (const char *json : {R"({"n": 007})", R"({"n": -})", R"({"n": 1.})", R"({"n": .5})", R"({"n": 1e})", R"({"n": 1+2})", R"({"n": --1})", R"({"n": -01})"}) {
+        bool threw = false;
+        try {
+            table::from_json(json);
+        }
+        catch (const std::runtime_error &) {
+            threw = true;
+        }
+        assert(threw);
+    }
+    const table parsed = table::from_json(R"({"a": 0, "b": -12, "c": 3000000000, "d": 0.5, "e": -1.25e+2, "f": 1E-2})");
+    assert(*parsed.find<int>("a") == 0);
+    assert(*parsed.find<int>("b") == -12);
+    assert(*parsed.find<long long>("c") == 3000000000LL);
+    assert(*parsed.find<double>("d") == 0.5);
+    assert(*parsed.find<double>("e") == -125.0);
+    assert(*parsed.find<double>("f") == 0.01);
+}
+
+/** Tests that escaped surrogate pairs become one UTF-8 code point and lone surrogates are rejected. */
+static void test_json_surrogates() {
+    for (const char *json : {R"({"s": "\ud83d"})", R"({"s": "\ud83dx"})", R"({"s": "\ude00"})", R"({"s": "\ud83d\u0041"})", R"({"s": "\ude00\ud83d"})", R"({"s": "\ud83d\n"})"}) {
+        bool threw = false;
+        try {
+            table::from_json(json);
+        }
+        catch (const std::runtime_error &) {
+            threw = true;
+        }
+        assert(threw);
+    }
+    const table parsed = table::from_json(R"({"s": "\ud83d\ude00", "e": "\u00e9"})");
+    assert(*parsed.find<std::string>("s") == "\xF0\x9F\x98\x80");
+    assert(*parsed.find<std::string>("e") == "\xC3\xA9");
+}
+
+
+// MAIN
+
+/** Entry point of the program. */
+int main() {
+    test_snapshot_after_borrow();
+    test_snapshot_without_borrow();
+    test_snapshot_after_modify();
+    test_snapshot_from_json();
+    test_json_numbers();
+    test_json_surrogates();
+    std::printf("Table tests passed!\n");
+    return 0;
+}
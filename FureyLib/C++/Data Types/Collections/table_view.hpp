@@ -0,0 +1,374 @@
+// .hpp
+// Read-Only Binary Table View Type
+// by Kyle Furey
+
+#pragma once
+#include "table.hpp"
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+// TABLE VIEW
+
+/**
+ * A read-only view of a table in the binary format written by table::to_binary().<br/>
+ * Lookups read straight from the bytes, which can be memory mapped from a file, without allocating any objects.
+ */
+class table_view final {
+
+    // DATA
+
+    /** The bytes of the binary table. */
+    const unsigned char *data;
+
+    /** The number of bytes of the binary table. */
+    size_t bytes;
+
+    /** The number of entries. */
+    uint32_t count;
+
+    /** The number of slots in the hash index. */
+    uint32_t index_size;
+
+    /** The offset of the first entry. */
+    size_t entries_offset;
+
+    /** The memory mapped file, or nullptr if this view does not own its bytes. */
+    void *mapping;
+
+#ifdef _WIN32
+    /** The handle of the file mapping. */
+    HANDLE mapping_handle;
+#endif
+
+
+    // TABLE VIEW
+
+    /** Validates the header of the bytes. */
+    void validate() {
+        if (bytes < table::BINARY_HEADER || std::memcmp(data, table::BINARY_MAGIC, sizeof(table::BINARY_MAGIC)) != 0) {
+            throw std::runtime_error("ERROR: Bytes are not a binary table!");
+        }
+        if (table::binary_get<uint32_t>(data + 4) != table::BINARY_VERSION) {
+            throw std::runtime_error("ERROR: Unsupported binary table version!");
+        }
+        count = table::binary_get<uint32_t>(data + 8);
+        index_size = table::binary_get<uint32_t>(data + 12);
+        entries_offset = (table::BINARY_HEADER + static_cast<size_t>(index_size) * 4 + 7) / 8 * 8;
+        if (index_size == 0 || (index_size & (index_size - 1)) != 0 || count > index_size ||
+            table::binary_get<uint64_t>(data + 16) != bytes || entries_offset + static_cast<size_t>(count) * table::BINARY_ENTRY > bytes) {
+            throw std::runtime_error("ERROR: Binary table is corrupt!");
+        }
+        if (reinterpret_cast<uintptr_t>(data) % 8 != 0) {
+            throw std::runtime_error("ERROR: Binary table bytes must be 8 byte aligned!");
+        }
+    }
+
+    /** Returns whether the given range lies within the bytes. */
+    bool in_bounds(const size_t offset, const size_t size) const noexcept {
+        return offset <= bytes && size <= bytes - offset;
+    }
+
+    /** Returns the entry with the given name, or nullptr. */
+    const unsigned char *find_entry(const std::string_view name) const noexcept {
+        const uint64_t hashed = table::binary_hash(name);
+        const uint32_t mask = index_size - 1;
+        uint32_t slot = static_cast<uint32_t>(hashed) & mask;
+        for (uint32_t probes = 0; probes < index_size; ++probes) {
+            const uint32_t number = table::binary_get<uint32_t>(data + table::BINARY_HEADER + slot * 4);
+            if (number == 0 || number > count) {
+                return nullptr;
+            }
+            const unsigned char *entry = data + entries_offset + (number - 1) * table::BINARY_ENTRY;
+            if (table::binary_get<uint64_t>(entry) == hashed) {
+                const uint32_t key_offset = table::binary_get<uint32_t>(entry + 8);
+                const uint32_t key_size = table::binary_get<uint32_t>(entry + 12);
+                if (key_size == name.size() && in_bounds(key_offset, key_size) && std::memcmp(data + key_offset, name.data(), key_size) == 0) {
+                    return entry;
+                }
+            }
+            slot = (slot + 1) & mask;
+        }
+        return nullptr;
+    }
+
+    /** Returns the string value of the given entry. */
+    std::string_view string_of(const unsigned char *entry) const noexcept {
+        const uint32_t offset = table::binary_get<uint32_t>(entry + 24);
+        const uint32_t size = table::binary_get<uint32_t>(entry + 28);
+        if (!in_bounds(offset, size)) {
+            return std::string_view();
+        }
+        return std::string_view(reinterpret_cast<const char *>(data + offset), size);
+    }
+
+    /** Decodes the value of the given entry as the given arithmetic type. */
+    template <typename T>
+    static T value_of(const unsigned char *entry) noexcept {
+        const uint64_t bits = table::binary_get<uint64_t>(entry + 24);
+        if constexpr (std::is_same_v<T, float>) {
+            const uint32_t narrow = static_cast<uint32_t>(bits);
+            T result;
+            std::memcpy(&result, &narrow, sizeof(result));
+            return result;
+        }
+        else if constexpr (std::is_same_v<T, double>) {
+            T result;
+            std::memcpy(&result, &bits, sizeof(result));
+            return result;
+        }
+        else {
+            return static_cast<T>(bits);
+        }
+    }
+
+    /** Unmaps any owned file. */
+    void release() noexcept {
+        if (mapping != nullptr) {
+#ifdef _WIN32
+            UnmapViewOfFile(mapping);
+            CloseHandle(mapping_handle);
+#else
+            munmap(mapping, bytes);
+#endif
+            mapping = nullptr;
+        }
+        data = nullptr;
+        bytes = 0;
+        count = 0;
+    }
+
+    /** Default constructor. */
+    table_view() noexcept : data(nullptr), bytes(0), count(0), index_size(0), entries_offset(0), mapping(nullptr)
+#ifdef _WIN32
+        , mapping_handle(nullptr)
+#endif
+    {
+    }
+
+public:
+
+    // CONSTRUCTORS AND DESTRUCTOR
+
+    /** Views the given bytes, which must be 8 byte aligned and outlive this view. Throws if they are not a binary table. */
+    table_view(const void *bytes, const size_t size) : table_view() {
+        data = static_cast<const unsigned char *>(bytes);
+        this->bytes = size;
+        validate();
+    }
+
+    /** Delete copy constructor. */
+    table_view(const table_view &) = delete;
+
+    /** Move constructor. */
+    table_view(table_view &&moved) noexcept : data(moved.data), bytes(moved.bytes), count(moved.count), index_size(moved.index_size),
+                                               entries_offset(moved.entries_offset), mapping(moved.mapping)
+#ifdef _WIN32
+                                               , mapping_handle(moved.mapping_handle)
+#endif
+    {
+        moved.mapping = nullptr;
+        moved.data = nullptr;
+        moved.bytes = 0;
+        moved.count = 0;
+    }
+
+    /** Destructor. */
+    ~table_view() {
+        release();
+    }
+
+
+    // OPERATORS
+
+    /** Delete copy assignment operator. */
+    table_view &operator=(const table_view &) = delete;
+
+    /** Move assignment operator. */
+    table_view &operator=(table_view &&moved) noexcept {
+        if (this != &moved) {
+            release();
+            data = moved.data;
+            bytes = moved.bytes;
+            count = moved.count;
+            index_size = moved.index_size;
+            entries_offset = moved.entries_offset;
+            mapping = moved.mapping;
+#ifdef _WIN32
+            mapping_handle = moved.mapping_handle;
+#endif
+            moved.mapping = nullptr;
+            moved.data = nullptr;
+            moved.bytes = 0;
+            moved.count = 0;
+        }
+        return *this;
+    }
+
+
+    // TABLE VIEW
+
+    /** Memory maps the binary table file at the given path. Throws if the file cannot be mapped or is not a binary table. */
+    static table_view open(const std::string &path) {
+        table_view view;
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error(std::string("ERROR: Could not open binary table ") + path + '!');
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+            CloseHandle(file);
+            throw std::runtime_error(std::string("ERROR: Could not read binary table ") + path + '!');
+        }
+        view.mapping_handle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (view.mapping_handle == nullptr) {
+            throw std::runtime_error(std::string("ERROR: Could not map binary table ") + path + '!');
+        }
+        view.mapping = MapViewOfFile(view.mapping_handle, FILE_MAP_READ, 0, 0, 0);
+        if (view.mapping == nullptr) {
+            CloseHandle(view.mapping_handle);
+            throw std::runtime_error(std::string("ERROR: Could not map binary table ") + path + '!');
+        }
+        view.bytes = static_cast<size_t>(size.QuadPart);
+#else
+        const int file = ::open(path.c_str(), O_RDONLY);
+        if (file < 0) {
+            throw std::runtime_error(std::string("ERROR: Could not open binary table ") + path + '!');
+        }
+        struct stat status;
+        if (fstat(file, &status) != 0 || status.st_size == 0) {
+            close(file);
+            throw std::runtime_error(std::string("ERROR: Could not read binary table ") + path + '!');
+        }
+        void *mapped = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        close(file);
+        if (mapped == MAP_FAILED) {
+            throw std::runtime_error(std::string("ERROR: Could not map binary table ") + path + '!');
+        }
+        view.mapping = mapped;
+        view.bytes = static_cast<size_t>(status.st_size);
+#endif
+        view.data = static_cast<const unsigned char *>(view.mapping);
+        view.validate();
+        return view;
+    }
+
+    /** Returns the number of entries. */
+    size_t size() const noexcept {
+        return count;
+    }
+
+    /** Returns the binary type tag of the entry with the given name, or NONE if it was not found. */
+    table::binary_type type_of(const std::string_view name) const noexcept {
+        const unsigned char *entry = find_entry(name);
+        return entry != nullptr ? static_cast<table::binary_type>(entry[16]) : table::binary_type::NONE;
+    }
+
+    /** Returns whether the view contains an entry of the given name. */
+    bool contains(const std::string_view name) const noexcept {
+        return find_entry(name) != nullptr;
+    }
+
+    /** Returns whether the view contains an entry of the given name and type. */
+    template <typename T>
+    bool contains(const std::string_view name) const noexcept {
+        return table::binary_type_of<T>() != table::binary_type::NONE && type_of(name) == table::binary_type_of<T>();
+    }
+
+    /**
+     * Returns a pointer into the bytes to the arithmetic value with the given name and type (or nullptr).<br/>
+     * Values are stored little-endian, so this is only available on little-endian targets. Use try_get() otherwise.
+     */
+    template <typename T>
+    const T *find(const std::string_view name) const noexcept {
+        static_assert(std::is_arithmetic_v<T>, "ERROR: table_view::find() only returns arithmetic values! Use find_string() for strings.");
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        static_assert(!std::is_arithmetic_v<T>, "ERROR: table_view::find() requires a little-endian target! Use try_get().");
+#endif
+        const unsigned char *entry = find_entry(name);
+        if (entry == nullptr || entry[16] != static_cast<unsigned char>(table::binary_type_of<T>())) {
+            return nullptr;
+        }
+        return reinterpret_cast<const T *>(entry + 24);
+    }
+
+    /** Returns a view into the bytes of the string with the given name, or an empty view with a null data pointer. */
+    std::string_view find_string(const std::string_view name) const noexcept {
+        const unsigned char *entry = find_entry(name);
+        if (entry == nullptr || entry[16] != static_cast<unsigned char>(table::binary_type::STRING)) {
+            return std::string_view();
+        }
+        return string_of(entry);
+    }
+
+    /** Copies the value with the given name and type into the given output and returns whether it was found. */
+    template <typename T>
+    bool try_get(const std::string_view name, T &out) const {
+        const unsigned char *entry = find_entry(name);
+        if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>) {
+            if (entry == nullptr || entry[16] != static_cast<unsigned char>(table::binary_type::STRING)) {
+                return false;
+            }
+            out = T(string_of(entry));
+        }
+        else {
+            if (entry == nullptr || entry[16] != static_cast<unsigned char>(table::binary_type_of<T>()) || table::binary_type_of<T>() == table::binary_type::NONE) {
+                return false;
+            }
+            out = value_of<T>(entry);
+        }
+        return true;
+    }
+
+    /**
+     * Copies every entry into a new table.<br/>
+     * Integers become the standard type of their width and signedness (for example, 64-bit integers become long long).
+     */
+    table to_table() const {
+        table result(static_cast<size_t>(count) * 2);
+        for (uint32_t number = 0; number < count; ++number) {
+            const unsigned char *entry = data + entries_offset + number * table::BINARY_ENTRY;
+            const uint32_t key_offset = table::binary_get<uint32_t>(entry + 8);
+            const uint32_t key_size = table::binary_get<uint32_t>(entry + 12);
+            if (!in_bounds(key_offset, key_size)) {
+                throw std::runtime_error("ERROR: Binary table is corrupt!");
+            }
+            const std::string_view name(reinterpret_cast<const char *>(data + key_offset), key_size);
+            switch (static_cast<table::binary_type>(entry[16])) {
+                case table::binary_type::BOOL: result.set<bool>(name, value_of<uint64_t>(entry) != 0); break;
+                case table::binary_type::CHAR: result.set<char>(name, value_of<char>(entry)); break;
+                case table::binary_type::INT8: result.set<signed char>(name, value_of<signed char>(entry)); break;
+                case table::binary_type::UINT8: result.set<unsigned char>(name, value_of<unsigned char>(entry)); break;
+                case table::binary_type::INT16: result.set<short>(name, value_of<short>(entry)); break;
+                case table::binary_type::UINT16: result.set<unsigned short>(name, value_of<unsigned short>(entry)); break;
+                case table::binary_type::INT32: result.set<int>(name, value_of<int>(entry)); break;
+                case table::binary_type::UINT32: result.set<unsigned>(name, value_of<unsigned>(entry)); break;
+                case table::binary_type::INT64: result.set<long long>(name, value_of<long long>(entry)); break;
+                case table::binary_type::UINT64: result.set<unsigned long long>(name, value_of<unsigned long long>(entry)); break;
+                case table::binary_type::FLOAT: result.set<float>(name, value_of<float>(entry)); break;
+                case table::binary_type::DOUBLE: result.set<double>(name, value_of<double>(entry)); break;
+                case table::binary_type::STRING: result.set<std::string>(name, string_of(entry)); break;
+                default: throw std::runtime_error("ERROR: Binary table is corrupt!");
+            }
+        }
+        return result;
+    }
+};
@@ -0,0 +1,164 @@
+// .h
+// Memory Arena Allocator Classes
+// by Kyle Furey
+
+#pragma once
+#include <memory_resource>
+#include <new>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include "../../../C/Data Types/Utilities/arena/arena.h"
+
+
+// MEMORY ARENA ALLOCATORS
+
+/**
+ * A polymorphic memory resource that allocates from a C memory arena, so std::pmr containers can use its fixed memory.<br/>
+ * The arena only aligns to ARENA_ALIGN bytes, so larger alignments are met by allocating extra bytes and storing the
+ * original address before the aligned one. Throws std::bad_alloc when the arena is full.
+ */
+class ArenaResource final : public std::pmr::memory_resource {
+
+	// DATA
+
+	/** The arena that memory is allocated from. */
+	arena* target;
+
+public:
+
+	// CONSTRUCTOR
+
+	/** Constructs a memory resource for the given arena. The arena must be zero-initialized before its first allocation. */
+	ArenaResource(arena& Arena) noexcept : target(&Arena) {
+	}
+
+
+	// RESOURCE
+
+	/** Returns the arena that memory is allocated from. */
+	arena& Arena() const noexcept {
+		return *target;
+	}
+
+	/** Allocates the given number of bytes with the given alignment from the given arena. Throws std::bad_alloc on failure. */
+	static void* Allocate(arena& Arena, const size_t Bytes, const size_t Alignment) {
+		if (Alignment <= ARENA_ALIGN) {
+			void* Pointer = arena_malloc(&Arena, Bytes != 0 ? Bytes : 1);
+			if (Pointer == nullptr) {
+				throw std::bad_alloc();
+			}
+			return Pointer;
+		}
+		if (Bytes > ARENA_SIZE || Alignment > ARENA_SIZE || (Alignment & (Alignment - 1)) != 0) {
+			throw std::bad_alloc();
+		}
+		uint8_t* Original = static_cast<uint8_t*>(arena_malloc(&Arena, Bytes + sizeof(void*) + Alignment - 1));
+		if (Original == nullptr) {
+			throw std::bad_alloc();
+		}
+		const uintptr_t Address = reinterpret_cast<uintptr_t>(Original) + sizeof(void*);
+		uint8_t* Aligned = Original + (((Address + Alignment - 1) & ~(Alignment - 1)) - reinterpret_cast<uintptr_t>(Original));
+		std::memcpy(Aligned - sizeof(void*), &Original, sizeof(void*));
+		return Aligned;
+	}
+
+	/** Frees memory from Allocate() with the same alignment back to the given arena. */
+	static void Deallocate(arena& Arena, void* Pointer, const size_t Alignment) noexcept {
+		if (Alignment <= ARENA_ALIGN) {
+			arena_free(&Arena, Pointer);
+		}
+		else {
+			void* Original = nullptr;
+			std::memcpy(&Original, static_cast<uint8_t*>(Pointer) - sizeof(void*), sizeof(void*));
+			arena_free(&Arena, Original);
+		}
+	}
+
+private:
+
+	// RESOURCE
+
+	/** Allocates the given number of bytes with the given alignment. */
+	void* do_allocate(const size_t Bytes, const size_t Alignment) override {
+		return Allocate(*target, Bytes, Alignment);
+	}
+
+	/** Frees memory allocated with the given alignment. */
+	void do_deallocate(void* Pointer, size_t, const size_t Alignment) override {
+		Deallocate(*target, Pointer, Alignment);
+	}
+
+	/** Returns whether the given resource allocates from the same arena. */
+	bool do_is_equal(const std::pmr::memory_resource& Other) const noexcept override {
+		const ArenaResource* Resource = dynamic_cast<const ArenaResource*>(&Other);
+		return Resource != nullptr && Resource->target == target;
+	}
+};
+
+/** A stateful allocator that allocates objects of the given type from a C memory arena, for standard containers. */
+template<typename Type>
+class ArenaAllocator {
+	template<typename OtherType>
+	friend class ArenaAllocator;
+
+	// DATA
+
+	/** The arena that objects are allocated from. */
+	arena* target;
+
+public:
+
+	// TYPES
+
+	/** The type of object allocated. */
+	using value_type = Type;
+
+
+	// CONSTRUCTORS
+
+	/** Constructs an allocator for the given arena. */
+	ArenaAllocator(arena& Arena) noexcept : target(&Arena) {
+	}
+
+	/** Constructs an allocator that shares another allocator's arena. */
+	template<typename OtherType>
+	ArenaAllocator(const ArenaAllocator<OtherType>& Other) noexcept : target(Other.target) {
+	}
+
+
+	// OPERATORS
+
+	/** Returns whether both allocators allocate from the same arena. */
+	template<typename OtherType>
+	bool operator==(const ArenaAllocator<OtherType>& Other) const noexcept {
+		return target == Other.target;
+	}
+
+	/** Returns whether the allocators allocate from different arenas. */
+	template<typename OtherType>
+	bool operator!=(const ArenaAllocator<OtherType>& Other) const noexcept {
+		return target != Other.target;
+	}
+
+
+	// ALLOCATOR
+
+	/** Returns the arena that objects are allocated from. */
+	arena& Arena() const noexcept {
+		return *target;
+	}
+
+	/** Allocates uninitialized memory for the given number of objects. Throws std::bad_alloc on failure. */
+	Type* allocate(const size_t Count) {
+		if (Count > ARENA_SIZE / sizeof(Type)) {
+			throw std::bad_alloc();
+		}
+		return static_cast<Type*>(ArenaResource::Allocate(*target, Count * sizeof(Type), alignof(Type)));
+	}
+
+	/** Frees memory from allocate(). */
+	void deallocate(Type* Pointer, size_t) noexcept {
+		ArenaResource::Deallocate(*target, Pointer, alignof(Type));
+	}
+};
@@ -4,12 +4,21 @@
 
 #pragma once
 #include <iostream>
-#include <map>
 #include <initializer_list>
 #include <stdexcept>
 #include <utility>
+#include <mutex>
+#include <atomic>
+#include <new>
 #include <cstring>
+#include <cstddef>
 #include <cstdint>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#include <memory_resource>
+#endif
 
 
 // MACROS
@@ -29,34 +38,930 @@
 #define MEMHEAP_SINGLETON 1
 #endif
 
+#ifndef MEMHEAP_CACHE_MAX
+// The largest size the Memory Heap Cache class caches per thread.
+#define MEMHEAP_CACHE_MAX 256
+#endif
+
+#ifndef MEMHEAP_CACHE_DEPTH
+// The number of blocks of each size the Memory Heap Cache class caches per thread.
+#define MEMHEAP_CACHE_DEPTH 32
+#endif
+
+#ifndef MEMHEAP_ALIGNMENT
+// The alignment of each block of memory allocated by the Memory Heap class.
+#define MEMHEAP_ALIGNMENT alignof(std::max_align_t)
+#endif
+
+#ifndef MEMHEAP_POOLS
+// Whether the Memory Heap class will pack blocks of 8 bytes to an eighth of a pool page (at most 256 bytes) into fixed-size pools.
+#define MEMHEAP_POOLS 0
+#endif
+
+#ifndef MEMHEAP_POOL_PAGE
+// The number of bytes of each pool page of the Memory Heap class. Must be a power of two.
+#define MEMHEAP_POOL_PAGE 1024
+#endif
+
+#ifndef MEMHEAP_STATS
+// Whether the Memory Heap class will record allocation statistics.
+#define MEMHEAP_STATS 0
+#endif
+
+#if MEMHEAP_STATS
+#include <string>
+#include <chrono>
+
+
+// MEMORY HEAP STATISTICS
+
+/** Allocation statistics recorded by a Memory Heap when MEMHEAP_STATS is enabled. */
+struct MemHeapStats final {
+
+	// CONSTANTS
+
+	/** The number of size classes. Size class N counts requests of [2^N, 2^(N+1)) bytes. */
+	static constexpr size_t CLASSES = sizeof(size_t) * 8;
+
+	/** The number of latency buckets. Bucket N counts calls that took [2^N, 2^(N+1)) nanoseconds. */
+	static constexpr size_t LATENCIES = 32;
+
+
+	// DATA
+
+	/** The number of successful allocations. */
+	size_t mallocs = 0;
+
+	/** The number of frees. */
+	size_t frees = 0;
+
+	/** The number of allocations that failed for lack of room. */
+	size_t failures = 0;
+
+	/** The number of reallocations that kept their pointer. */
+	size_t reallocsInPlace = 0;
+
+	/** The number of reallocations that moved their memory. */
+	size_t reallocsMoved = 0;
+
+	/** The number of bytes currently allocated. */
+	size_t usage = 0;
+
+	/** The most bytes ever allocated at once. */
+	size_t peakUsage = 0;
+
+	/** The number of blocks currently allocated. */
+	size_t allocations = 0;
+
+	/** The most blocks ever allocated at once. */
+	size_t peakAllocations = 0;
+
+	/** The number of free bytes, excluding headers. Computed when the statistics are read. */
+	size_t freeBytes = 0;
+
+	/** The number of free blocks. Computed when the statistics are read. */
+	size_t freeBlocks = 0;
+
+	/** The size of the largest free block, which bounds the largest possible allocation. Computed when the statistics are read. */
+	size_t largestFreeBlock = 0;
+
+	/** The external fragmentation: 1 - largestFreeBlock / freeBytes. Computed when the statistics are read. */
+	double fragmentation = 0;
+
+	/** The number of successful allocations of each size class. */
+	size_t classMallocs[CLASSES] = {};
+
+	/** The number of frees of each size class. */
+	size_t classFrees[CLASSES] = {};
+
+	/** The most blocks of each size class ever allocated at once. */
+	size_t classPeaks[CLASSES] = {};
+
+	/** A histogram of the time each allocation took. */
+	size_t mallocLatency[LATENCIES] = {};
+
+	/** A histogram of the time each free took. */
+	size_t freeLatency[LATENCIES] = {};
+
+
+	// STATISTICS
+
+	/** Returns these statistics as JSON. */
+	std::string ToJson() const {
+		std::string Json = "{";
+		const auto Field = [&Json](const char* Name, const std::string& Value) {
+			if (Json.size() > 1) {
+				Json += ',';
+			}
+			Json += '"';
+			Json += Name;
+			Json += "\":";
+			Json += Value;
+		};
+		const auto Array = [](const size_t* Values, const size_t Count) {
+			size_t Length = Count;
+			while (Length > 0 && Values[Length - 1] == 0) {
+				--Length;
+			}
+			std::string Result = "[";
+			for (size_t Index = 0; Index < Length; ++Index) {
+				if (Index > 0) {
+					Result += ',';
+				}
+				Result += std::to_string(Values[Index]);
+			}
+			return Result + "]";
+		};
+		Field("mallocs", std::to_string(mallocs));
+		Field("frees", std::to_string(frees));
+		Field("failures", std::to_string(failures));
+		Field("reallocsInPlace", std::to_string(reallocsInPlace));
+		Field("reallocsMoved", std::to_string(reallocsMoved));
+		Field("usage", std::to_string(usage));
+		Field("peakUsage", std::to_string(peakUsage));
+		Field("allocations", std::to_string(allocations));
+		Field("peakAllocations", std::to_string(peakAllocations));
+		Field("freeBytes", std::to_string(freeBytes));
+		Field("freeBlocks", std::to_string(freeBlocks));
+		Field("largestFreeBlock", std::to_string(largestFreeBlock));
+		Field("fragmentation", std::to_string(fragmentation));
+		Field("classMallocs", Array(classMallocs, CLASSES));
+		Field("classFrees", Array(classFrees, CLASSES));
+		Field("classPeaks", Array(classPeaks, CLASSES));
+		Field("mallocLatency", Array(mallocLatency, LATENCIES));
+		Field("freeLatency", Array(freeLatency, LATENCIES));
+		return Json + "}";
+	}
+};
+#endif	// MEMHEAP_STATS
+
 
 // MEMORY HEAP
 
-/** A class that manages a fixed block of memory that can be used to allocate and deallocate blocks dynamically. */
+/**
+ * A class that manages a fixed block of memory that can be used to allocate and deallocate blocks dynamically.<br/>
+ * Blocks are tracked in-band with a two-level segregated fit allocator: each block has a small header, and free blocks are
+ * kept in lists by size class, found through two bitmaps. Malloc and Free run in constant time and never use the global heap.
+ * Freed blocks are merged with free neighbors using boundary tags, and a bitmap of allocated blocks rejects pointers that
+ * were never returned. When MEMHEAP_POOLS is enabled, small blocks (up to an eighth of a pool page, at most 256 bytes) are
+ * instead packed without headers into pages of equal-sized blocks, aligned so that no block straddles a cache line.
+ */
 template<size_t SIZE = MEMHEAP_DEFAULT_SIZE>
 class MemHeap final {
 	static_assert(SIZE != 0, "ERROR: Cannot allocate a heap with 0 bytes!");
 
+	// BLOCKS
+
+	/**
+	 * The header in front of each block of memory in this heap.<br/>
+	 * Free blocks also store links to the other free blocks of their size class at the start of their memory,
+	 * and a pointer back to their header at the end of their memory so the next block can find them.
+	 */
+	struct Block final {
+		/** The number of bytes after this header. The lowest bits flag whether this block and the block before it are free. */
+		size_t size;
+
+		/** The number of bytes requested for this block, or zero if it is free. */
+		size_t used;
+	};
+
+	/** The alignment of each block's memory. */
+	static constexpr size_t ALIGNMENT = MEMHEAP_ALIGNMENT;
+	static_assert(ALIGNMENT >= alignof(Block) && (ALIGNMENT & (ALIGNMENT - 1)) == 0, "ERROR: The heap's alignment must be a power of two!");
+
+	/** Flags a free block. */
+	static constexpr size_t FREE = 1;
+
+	/** Flags a block whose previous neighbor is free. */
+	static constexpr size_t PREVIOUS_FREE = 2;
+
+	/** Each flag stored in a block's size. */
+	static constexpr size_t FLAGS = FREE | PREVIOUS_FREE;
+
+	/** Rounds the given size up to a multiple of the given power of two. */
+	static constexpr size_t RoundUp(const size_t Size, const size_t Alignment) {
+		return (Size + Alignment - 1) & ~(Alignment - 1);
+	}
+
+	/** Returns the index of the highest set bit of the given nonzero value at compile time. */
+	static constexpr size_t Log2(const size_t Value) {
+		return Value <= 1 ? 0 : 1 + Log2(Value >> 1);
+	}
+
+	/** The number of bytes of each block's header. */
+	static constexpr size_t HEADER = RoundUp(sizeof(Block), ALIGNMENT);
+
+	/** The fewest bytes a block can hold, enough for a free block's links and footer. */
+	static constexpr size_t MINIMUM = RoundUp(3 * sizeof(Block*), ALIGNMENT);
+
+	/** The number of bytes of memory that are divided into blocks. */
+	static constexpr size_t CAPACITY = SIZE / ALIGNMENT * ALIGNMENT;
+	static_assert(CAPACITY >= HEADER + MINIMUM, "ERROR: The heap is too small to hold a block!");
+
+	/** The number of bits in each word of the allocated block marks. */
+	static constexpr size_t MARK_BITS = sizeof(size_t) * 8;
+
+	/** The number of words of allocated block marks, one bit for every ALIGNMENT bytes of memory. */
+	static constexpr size_t MARK_WORDS = (CAPACITY / ALIGNMENT + MARK_BITS - 1) / MARK_BITS;
+
+
+	// SIZE CLASSES
+
+	/** The number of bits of a block's size below its highest bit used to choose its size class. */
+	static constexpr size_t SECOND_BITS = 4;
+
+	/** The number of size classes between each power of two. */
+	static constexpr size_t SECOND_COUNT = static_cast<size_t>(1) << SECOND_BITS;
+
+	/** Sizes below this are divided into size classes of ALIGNMENT bytes each. */
+	static constexpr size_t SMALL = SECOND_COUNT * ALIGNMENT;
+
+	/** The number of powers of two that sizes are divided into. */
+	static constexpr size_t FIRST_COUNT = CAPACITY < SMALL ? 1 : Log2(CAPACITY) - Log2(SMALL) + 2;
+
+#if MEMHEAP_POOLS
+	// POOLS
+
+	/** The number of bytes of each pool page. Pages are aligned to their size, so each pooled block is aligned to its own size. */
+	static constexpr size_t PAGE = MEMHEAP_POOL_PAGE;
+	static_assert(PAGE >= 128 && (PAGE & (PAGE - 1)) == 0, "ERROR: The heap's pool pages must be a power of two of at least 128 bytes!");
+
+	/** The number of bytes of each pool page that hold blocks, leaving room for the header of the block after the page. */
+	static constexpr size_t PAGE_USABLE = PAGE - HEADER;
+
+	/** The size of the smallest pooled blocks. */
+	static constexpr size_t POOL_MIN = 8;
+	static_assert(POOL_MIN >= sizeof(void*), "ERROR: Pooled blocks must be able to hold a pointer!");
+	static_assert(PAGE > HEADER && PAGE_USABLE / 8 >= POOL_MIN, "ERROR: The heap's pool pages must hold 8 of the smallest pooled blocks!");
+
+	/** The number of pooled block sizes, each a power of two. A page holds at least 8 of its largest blocks, so little of it is left over. */
+	static constexpr size_t POOL_CLASSES = Log2(PAGE_USABLE / 8 / POOL_MIN) < 5 ? Log2(PAGE_USABLE / 8 / POOL_MIN) + 1 : 6;
+
+	/** The size of the largest pooled blocks: 64 bytes with the default 1024-byte pages, and 256 bytes with 4096-byte pages. */
+	static constexpr size_t POOL_MAX = POOL_MIN << (POOL_CLASSES - 1);
+
+	/** The number of page-sized regions the heap's memory can touch. */
+	static constexpr size_t REGIONS = SIZE / PAGE + 2;
+
+	/** The number of words of allocated block marks of each pool page, one bit for each of its smallest blocks. */
+	static constexpr size_t SLOT_WORDS = (PAGE_USABLE / POOL_MIN + MARK_BITS - 1) / MARK_BITS;
+
+	/** One page-sized region of memory, which is a pool page if its block size is nonzero. */
+	struct Pool final {
+		/** The size of each block in this page, or zero if this region is not a pool page. */
+		size_t slot;
+
+		/** The number of allocated blocks. */
+		size_t live;
+
+		/** The number of blocks handed out from the end of the page so far. */
+		size_t carved;
+
+		/** The most recently freed block, which links to the block freed before it. */
+		void* free;
+
+		/** The next page of the same block size with free blocks. */
+		Pool* next;
+
+		/** The previous page of the same block size with free blocks. */
+		Pool* previous;
+
+		/** Marks each allocated block of this page, so double frees are rejected. */
+		std::atomic<size_t> allocated[SLOT_WORDS];
+	};
+#endif
+
+
 	// DATA
 
 	/** The number of bytes currently allocated in the heap. */
 	size_t usage;
 
+	/** The number of blocks currently allocated in the heap. */
+	size_t count;
+
 	/** The underlying block of memory managed by this heap. */
-	uint8_t memory[SIZE];
+	alignas(ALIGNMENT) uint8_t memory[SIZE];
+
+	/** Each power of two that has at least one free block. */
+	size_t firstMap;
+
+	/** Each size class of each power of two that has at least one free block. */
+	size_t secondMaps[FIRST_COUNT];
+
+	/** The first free block of each size class. */
+	Block* lists[FIRST_COUNT][SECOND_COUNT];
+
+	/** Marks the memory of each allocated block so pointers that were never returned by this heap are rejected. Words are atomic so they can be read without a lock. */
+	std::atomic<size_t> marks[MARK_WORDS];
+
+#if MEMHEAP_POOLS
+	/** The state of each page-sized region of memory. */
+	Pool pools[REGIONS];
+
+	/** The first pool page of each block size with free blocks. */
+	Pool* partial[POOL_CLASSES];
+#endif
+
+#if MEMHEAP_STATS
+	/** The recorded allocation statistics. */
+	MemHeapStats stats;
+
+	/** The number of blocks of each size class currently allocated. */
+	size_t classLive[MemHeapStats::CLASSES];
+#endif
+
+
+	// BLOCKS
+
+	/** Returns the index of the highest set bit of the given nonzero value. */
+	static size_t HighestBit(const size_t Value) {
+#if defined(__GNUC__) || defined(__clang__)
+		return sizeof(unsigned long long) * 8 - 1 - static_cast<size_t>(__builtin_clzll(Value));
+#elif defined(_MSC_VER) && defined(_WIN64)
+		unsigned long Index;
+		_BitScanReverse64(&Index, Value);
+		return Index;
+#else
+		return Log2(Value);
+#endif
+	}
+
+	/** Returns the index of the lowest set bit of the given nonzero value. */
+	static size_t LowestBit(const size_t Value) {
+#if defined(__GNUC__) || defined(__clang__)
+		return static_cast<size_t>(__builtin_ctzll(Value));
+#elif defined(_MSC_VER) && defined(_WIN64)
+		unsigned long Index;
+		_BitScanForward64(&Index, Value);
+		return Index;
+#else
+		return Log2(Value & (~Value + 1));
+#endif
+	}
+
+	/** Returns the number of bytes the given block can hold. */
+	static size_t SizeOf(const Block* Current) {
+		return Current->size & ~FLAGS;
+	}
+
+	/** Returns the memory of the given block. */
+	static uint8_t* Data(Block* Current) {
+		return reinterpret_cast<uint8_t*>(Current) + HEADER;
+	}
+
+	/** Returns the next free block in the given free block's size class. */
+	static Block*& NextFree(Block* Current) {
+		return reinterpret_cast<Block**>(Data(Current))[0];
+	}
+
+	/** Returns the previous free block in the given free block's size class. */
+	static Block*& PreviousFree(Block* Current) {
+		return reinterpret_cast<Block**>(Data(Current))[1];
+	}
+
+	/** Returns the footer at the end of the given free block, which points back to its header. */
+	static Block*& Footer(Block* Current) {
+		return reinterpret_cast<Block**>(Data(Current) + SizeOf(Current))[-1];
+	}
+
+	/** Returns the block after the given block, or nullptr if it is the last block. */
+	Block* Next(Block* Current) {
+		uint8_t* Following = Data(Current) + SizeOf(Current);
+		return Following < memory + CAPACITY ? reinterpret_cast<Block*>(Following) : nullptr;
+	}
+
+	/** Returns the free block before the given block. The given block must be flagged PREVIOUS_FREE. */
+	static Block* Previous(Block* Current) {
+		return reinterpret_cast<Block**>(Current)[-1];
+	}
+
+	/** Returns whether the given bit of the given marks is set. */
+	static bool IsMarked(const std::atomic<size_t>* Words, const size_t Index) {
+		return (Words[Index / MARK_BITS].load(std::memory_order_relaxed) & (static_cast<size_t>(1) << (Index % MARK_BITS))) != 0;
+	}
+
+	/** Sets or clears the given bit of the given marks. Marks are only written under the heap's lock, so this does not need to be atomic. */
+	static void SetMark(std::atomic<size_t>* Words, const size_t Index, const bool Marked) {
+		const size_t Bit = static_cast<size_t>(1) << (Index % MARK_BITS);
+		const size_t Word = Words[Index / MARK_BITS].load(std::memory_order_relaxed);
+		Words[Index / MARK_BITS].store(Marked ? Word | Bit : Word & ~Bit, std::memory_order_relaxed);
+	}
+
+	/** Marks the given block as allocated. */
+	void Mark(Block* Current) {
+		SetMark(marks, static_cast<size_t>(Data(Current) - memory) / ALIGNMENT, true);
+	}
+
+	/** Unmarks the given block as allocated. */
+	void Unmark(Block* Current) {
+		SetMark(marks, static_cast<size_t>(Data(Current) - memory) / ALIGNMENT, false);
+	}
+
+	/** Returns the allocated block of the given pointer, or nullptr if it is not the memory of an allocated block. Runs in constant time. */
+	Block* Find(void* Pointer) const {
+		uint8_t* Address = static_cast<uint8_t*>(Pointer);
+		uint8_t* Start = const_cast<uint8_t*>(memory);
+		if (Address < Start + HEADER || Address >= Start + CAPACITY || static_cast<size_t>(Address - Start) % ALIGNMENT != 0) {
+			return nullptr;
+		}
+		if (!IsMarked(marks, static_cast<size_t>(Address - Start) / ALIGNMENT)) {
+			return nullptr;
+		}
+		return reinterpret_cast<Block*>(Address - HEADER);
+	}
+
+	/** Returns the size class of the given size. */
+	static void Classify(const size_t Size, size_t& First, size_t& Second) {
+		if (Size < SMALL) {
+			First = 0;
+			Second = Size / ALIGNMENT;
+		}
+		else {
+			const size_t Bit = HighestBit(Size);
+			First = Bit - Log2(SMALL) + 1;
+			Second = (Size >> (Bit - SECOND_BITS)) - SECOND_COUNT;
+		}
+	}
+
+	/** Adds the given free block to its size class and flags it in the next block. */
+	void Insert(Block* Current) {
+		size_t First, Second;
+		Classify(SizeOf(Current), First, Second);
+		Block* Head = lists[First][Second];
+		NextFree(Current) = Head;
+		PreviousFree(Current) = nullptr;
+		if (Head != nullptr) {
+			PreviousFree(Head) = Current;
+		}
+		lists[First][Second] = Current;
+		firstMap |= static_cast<size_t>(1) << First;
+		secondMaps[First] |= static_cast<size_t>(1) << Second;
+		Footer(Current) = Current;
+		Block* Following = Next(Current);
+		if (Following != nullptr) {
+			Following->size |= PREVIOUS_FREE;
+		}
+	}
+
+	/** Removes the given free block from its size class and unflags it in the next block. */
+	void Remove(Block* Current) {
+		size_t First, Second;
+		Classify(SizeOf(Current), First, Second);
+		Block* After = NextFree(Current);
+		Block* Before = PreviousFree(Current);
+		if (After != nullptr) {
+			PreviousFree(After) = Before;
+		}
+		if (Before != nullptr) {
+			NextFree(Before) = After;
+		}
+		else {
+			lists[First][Second] = After;
+			if (After == nullptr) {
+				secondMaps[First] &= ~(static_cast<size_t>(1) << Second);
+				if (secondMaps[First] == 0) {
+					firstMap &= ~(static_cast<size_t>(1) << First);
+				}
+			}
+		}
+		Block* Following = Next(Current);
+		if (Following != nullptr) {
+			Following->size &= ~PREVIOUS_FREE;
+		}
+	}
+
+	/**
+	 * Returns a free block that can hold the given size, or nullptr if there is none.<br/>
+	 * The size is rounded up to the next size class so any block found fits. If none is free, only the first block of the
+	 * request's own size class is checked, so a nearly full heap can still hand out its largest block in constant time.
+	 */
+	Block* FindFree(const size_t Size) {
+		size_t First, Second;
+		const size_t Rounded = Size < SMALL ? Size : Size + (static_cast<size_t>(1) << (HighestBit(Size) - SECOND_BITS)) - 1;
+		Classify(Rounded, First, Second);
+		if (First < FIRST_COUNT) {
+			size_t Seconds = secondMaps[First] & (~static_cast<size_t>(0) << Second);
+			if (Seconds == 0) {
+				const size_t Firsts = First + 1 < FIRST_COUNT ? firstMap & (~static_cast<size_t>(0) << (First + 1)) : 0;
+				if (Firsts != 0) {
+					First = LowestBit(Firsts);
+					Seconds = secondMaps[First];
+				}
+			}
+			if (Seconds != 0) {
+				return lists[First][LowestBit(Seconds)];
+			}
+		}
+		Classify(Size, First, Second);
+		Block* Current = lists[First][Second];
+		return Current != nullptr && SizeOf(Current) >= Size ? Current : nullptr;
+	}
+
+	/** Merges the given free block with its free neighbors and adds the merged block to its size class. */
+	void Coalesce(Block* Current) {
+		Block* Following = Next(Current);
+		if (Following != nullptr && (Following->size & FREE) != 0) {
+			Remove(Following);
+			Current->size += HEADER + SizeOf(Following);
+		}
+		if ((Current->size & PREVIOUS_FREE) != 0) {
+			Block* Preceding = Previous(Current);
+			Remove(Preceding);
+			Preceding->size += HEADER + SizeOf(Current);
+			Current = Preceding;
+		}
+		Insert(Current);
+	}
+
+	/** Splits the end of the given allocated block off into a new free block if it holds enough bytes more than the given size. */
+	void Split(Block* Current, const size_t Size) {
+		const size_t Total = SizeOf(Current);
+		if (Total >= Size + HEADER + MINIMUM) {
+			Block* Remainder = reinterpret_cast<Block*>(Data(Current) + Size);
+			Remainder->size = (Total - Size - HEADER) | FREE;
+			Remainder->used = 0;
+			Current->size = Size | (Current->size & FLAGS);
+			Coalesce(Remainder);
+		}
+	}
+
+	/**
+	 * Resizes the given allocated block to hold the given size without moving its memory, by shrinking it or by growing
+	 * it into the free block after it. Returns false if the block after it is not free or not large enough.
+	 */
+	bool ResizeInPlace(Block* Current, const size_t Size) {
+		const size_t Needed = Size < MINIMUM ? MINIMUM : RoundUp(Size, ALIGNMENT);
+		if (Needed > SizeOf(Current)) {
+			Block* Following = Next(Current);
+			if (Following == nullptr || (Following->size & FREE) == 0 || SizeOf(Current) + HEADER + SizeOf(Following) < Needed) {
+				return false;
+			}
+			Remove(Following);
+			Current->size += HEADER + SizeOf(Following);
+		}
+		Split(Current, Needed);
+		usage = usage - Current->used + Size;
+		Current->used = Size;
+		return true;
+	}
+
+	/**
+	 * Moves the given allocated block back into the free block before it, merged with any free block after it, so it can hold
+	 * the given size. Returns the moved block, or nullptr if the merged blocks are not large enough.
+	 */
+	Block* ResizeBackward(Block* Current, const size_t Size) {
+		if ((Current->size & PREVIOUS_FREE) == 0) {
+			return nullptr;
+		}
+		const size_t Needed = Size < MINIMUM ? MINIMUM : RoundUp(Size, ALIGNMENT);
+		Block* Preceding = Previous(Current);
+		Block* Following = Next(Current);
+		if (Following != nullptr && (Following->size & FREE) == 0) {
+			Following = nullptr;
+		}
+		const size_t Total = SizeOf(Preceding) + HEADER + SizeOf(Current) + (Following != nullptr ? HEADER + SizeOf(Following) : 0);
+		if (Total < Needed) {
+			return nullptr;
+		}
+		const size_t Used = Current->used;
+		Remove(Preceding);
+		if (Following != nullptr) {
+			Remove(Following);
+		}
+		std::memmove(Data(Preceding), Data(Current), Used);
+		Unmark(Current);
+		Mark(Preceding);
+		Preceding->size = Total | (Preceding->size & PREVIOUS_FREE);
+		Split(Preceding, Needed);
+		usage = usage - Used + Size;
+		Preceding->used = Size;
+		return Preceding;
+	}
+
+	/**
+	 * Takes a free block that holds the given rounded size with its memory aligned to the given power of two, or returns nullptr.<br/>
+	 * Alignments above ALIGNMENT search for enough extra room to split a free block off the front of the found block.
+	 */
+	Block* Take(const size_t Needed, const size_t Align) {
+		const size_t Padding = Align > ALIGNMENT ? Align - ALIGNMENT + HEADER + MINIMUM : 0;
+		if (Needed > CAPACITY || Padding > CAPACITY - Needed) {
+			return nullptr;
+		}
+		Block* Found = FindFree(Needed + Padding);
+		if (Found == nullptr) {
+			return nullptr;
+		}
+		Remove(Found);
+		const uintptr_t Address = reinterpret_cast<uintptr_t>(Data(Found));
+		if ((Address & (Align - 1)) != 0) {
+			const size_t Lead = RoundUp(Address + HEADER + MINIMUM, Align) - Address - HEADER;
+			Block* Aligned = reinterpret_cast<Block*>(Data(Found) + Lead);
+			Aligned->size = SizeOf(Found) - Lead - HEADER;
+			Aligned->used = 0;
+			Found->size = Lead | (Found->size & FLAGS);
+			Insert(Found);
+			Found = Aligned;
+		}
+		else {
+			Found->size &= ~FREE;
+		}
+		Split(Found, Needed);
+		return Found;
+	}
+
+#if MEMHEAP_POOLS
+	/** Returns the region of memory that holds the given address. */
+	Pool* PageOf(const void* Pointer) const {
+		const uintptr_t Base = reinterpret_cast<uintptr_t>(memory) & ~(PAGE - 1);
+		return const_cast<Pool*>(pools + (reinterpret_cast<uintptr_t>(Pointer) - Base) / PAGE);
+	}
+
+	/** Returns the first byte of the given pool page. */
+	uint8_t* PageStart(const Pool* Page) const {
+		const uintptr_t Base = reinterpret_cast<uintptr_t>(memory) & ~(PAGE - 1);
+		return reinterpret_cast<uint8_t*>(Base + static_cast<size_t>(Page - pools) * PAGE);
+	}
+
+	/** Returns the pool page of the given pooled block, or nullptr if it is not a block of a pool page. */
+	Pool* PoolOf(const void* Pointer) const {
+		if (!Owns(const_cast<void*>(Pointer))) {
+			return nullptr;
+		}
+		Pool* Page = PageOf(Pointer);
+		const size_t Offset = reinterpret_cast<uintptr_t>(Pointer) & (PAGE - 1);
+		if (Page->slot == 0 || Offset % Page->slot != 0 || Offset >= Page->carved * Page->slot) {
+			return nullptr;
+		}
+		if (!IsMarked(Page->allocated, Offset / Page->slot)) {
+			return nullptr;
+		}
+		return Page;
+	}
+
+	/** Marks or unmarks the given block of the given pool page as allocated. */
+	static void MarkSlot(Pool* Page, const void* Slot, const bool Allocated) {
+		SetMark(Page->allocated, (reinterpret_cast<uintptr_t>(Slot) & (PAGE - 1)) / Page->slot, Allocated);
+	}
+
+	/** Returns the pooled block size class of the given nonzero size, which must be at most POOL_MAX. */
+	static size_t PoolClass(const size_t Size) {
+		return Size <= POOL_MIN ? 0 : HighestBit(Size - 1) + 1 - Log2(POOL_MIN);
+	}
+
+	/** Adds the given pool page to the front of its block size's pages with free blocks. */
+	void Link(Pool* Page) {
+		Pool*& Head = partial[PoolClass(Page->slot)];
+		Page->next = Head;
+		Page->previous = nullptr;
+		if (Head != nullptr) {
+			Head->previous = Page;
+		}
+		Head = Page;
+	}
+
+	/** Removes the given pool page from its block size's pages with free blocks. */
+	void Unlink(Pool* Page) {
+		if (Page->next != nullptr) {
+			Page->next->previous = Page->previous;
+		}
+		if (Page->previous != nullptr) {
+			Page->previous->next = Page->next;
+		}
+		else {
+			partial[PoolClass(Page->slot)] = Page->next;
+		}
+	}
+
+	/** Takes a block of the given pooled size class, starting a new pool page if needed, or returns nullptr if there is no room. */
+	void* TakeSlot(const size_t Class) {
+		Pool* Page = partial[Class];
+		if (Page == nullptr) {
+			Block* Found = Take(PAGE_USABLE, PAGE);
+			if (Found == nullptr) {
+				return nullptr;
+			}
+			Found->used = PAGE_USABLE;
+			Page = PageOf(Data(Found));
+			Page->slot = POOL_MIN << Class;
+			Page->live = 0;
+			Page->carved = 0;
+			Page->free = nullptr;
+			Link(Page);
+		}
+		void* Slot = Page->free;
+		if (Slot != nullptr) {
+			Page->free = *static_cast<void**>(Slot);
+		}
+		else {
+			Slot = PageStart(Page) + Page->carved++ * Page->slot;
+		}
+		MarkSlot(Page, Slot, true);
+		if (++Page->live == PAGE_USABLE / Page->slot) {
+			Unlink(Page);
+		}
+		return Slot;
+	}
 
-	/** Each allocated block of memory and its size. */
-	std::map<void*, size_t> blocks;
+	/** Returns the given empty pool page's memory to the heap. */
+	void ReleasePage(Pool* Page) {
+		Unlink(Page);
+		Page->slot = 0;
+		Block* Current = reinterpret_cast<Block*>(PageStart(Page) - HEADER);
+		Current->used = 0;
+		Current->size |= FREE;
+		Coalesce(Current);
+	}
+
+	/** Returns the given block to its pool page. Empty pages are returned to the heap unless they are the only page of their size with room. */
+	void FreeSlot(Pool* Page, void* Slot) {
+		MarkSlot(Page, Slot, false);
+		*static_cast<void**>(Slot) = Page->free;
+		Page->free = Slot;
+		if (Page->live-- == PAGE_USABLE / Page->slot) {
+			Link(Page);
+		}
+		if (Page->live == 0 && (Page->next != nullptr || Page->previous != nullptr)) {
+			ReleasePage(Page);
+		}
+	}
+
+	/** Returns every empty pool page's memory to the heap. Returns whether any page was returned. */
+	bool ReleaseEmptyPages() {
+		bool Released = false;
+		for (Pool* Head : partial) {
+			if (Head != nullptr && Head->live == 0) {
+				ReleasePage(Head);
+				Released = true;
+			}
+		}
+		return Released;
+	}
+#endif
+
+	/**
+	 * Allocates a block of the given nonzero size aligned to at least the given power of two, or returns nullptr if there is no room.<br/>
+	 * Sizes that fit a pool use it when pooled, and are aligned to their pooled block size.
+	 */
+	void* Allocate(const size_t Size, const size_t Align, const bool Pooled = true) {
+#if MEMHEAP_STATS
+		const auto Start = std::chrono::steady_clock::now();
+#endif
+		void* Pointer = nullptr;
+		size_t Bytes = Size;
+#if MEMHEAP_POOLS
+		if (Pooled && Size <= POOL_MAX && (POOL_MIN << PoolClass(Size)) >= Align) {
+			Pointer = TakeSlot(PoolClass(Size));
+			Bytes = POOL_MIN << PoolClass(Size);
+		}
+#else
+		static_cast<void>(Pooled);
+#endif
+		if (Pointer == nullptr && Size <= CAPACITY) {
+			const size_t Needed = Size < MINIMUM ? MINIMUM : RoundUp(Size, ALIGNMENT);
+			Block* Found = Take(Needed, Align);
+#if MEMHEAP_POOLS
+			if (Found == nullptr && ReleaseEmptyPages()) {
+				Found = Take(Needed, Align);
+			}
+#endif
+			if (Found != nullptr) {
+				Found->used = Size;
+				Mark(Found);
+				Pointer = Data(Found);
+				Bytes = Size;
+			}
+		}
+		if (Pointer == nullptr) {
+#if MEMHEAP_STATS
+			++stats.failures;
+#endif
+			return nullptr;
+		}
+		usage += Bytes;
+		++count;
+#if MEMHEAP_STATS
+		const size_t Class = HighestBit(Bytes);
+		++stats.mallocs;
+		++stats.classMallocs[Class];
+		if (++classLive[Class] > stats.classPeaks[Class]) {
+			stats.classPeaks[Class] = classLive[Class];
+		}
+		RecordPeaks();
+		RecordLatency(stats.mallocLatency, Start);
+#endif
+		return Pointer;
+	}
+
+	/** Allocates a block like Allocate(), but reports invalid requests and failures according to MEMHEAP_THROWS. */
+	void* Reserve(const size_t Size, const size_t Align, const bool Pooled) {
+		if (Size == 0) {
+#if MEMHEAP_THROWS
+			std::cerr << "\n\nERROR: Allocating zero bytes of memory!" << std::endl;
+			throw std::runtime_error("ERROR: Allocating zero bytes of memory!");
+#else
+			return nullptr;
+#endif
+		}
+		if (Size > SIZE) {
+#if MEMHEAP_THROWS
+			std::cerr << "\n\nERROR: Allocating more memory than the heap!" << std::endl;
+			throw std::runtime_error("ERROR: Allocating more memory than the heap!");
+#else
+			return nullptr;
+#endif
+		}
+		if (Align == 0 || (Align & (Align - 1)) != 0) {
+#if MEMHEAP_THROWS
+			std::cerr << "\n\nERROR: Allocating memory with an alignment that is not a power of two!" << std::endl;
+			throw std::runtime_error("ERROR: Allocating memory with an alignment that is not a power of two!");
+#else
+			return nullptr;
+#endif
+		}
+		void* Pointer = Allocate(Size, Align, Pooled);
+		if (Pointer == nullptr) {
+#if MEMHEAP_THROWS
+			std::cerr << "\n\nERROR: Out of heap memory!" << std::endl;
+			throw std::runtime_error("ERROR: Out of heap memory!");
+#else
+			return nullptr;
+#endif
+		}
+		return Pointer;
+	}
+
+	/** Returns the given pointer's memory to its pool or to the free blocks, and returns the number of bytes freed, or zero if it was not allocated. */
+	size_t Release(void* Pointer) {
+#if MEMHEAP_POOLS
+		Pool* Page = PoolOf(Pointer);
+		if (Page != nullptr) {
+			const size_t Bytes = Page->slot;
+			FreeSlot(Page, Pointer);
+			return Bytes;
+		}
+#endif
+		Block* Current = Find(Pointer);
+		if (Current == nullptr) {
+			return 0;
+		}
+		const size_t Bytes = Current->used;
+		Unmark(Current);
+		Current->used = 0;
+		Current->size |= FREE;
+		Coalesce(Current);
+		return Bytes;
+	}
+
+#if MEMHEAP_STATS
+	/** Records the current usage and number of allocations if they are the highest yet. */
+	void RecordPeaks() {
+		if (usage > stats.peakUsage) {
+			stats.peakUsage = usage;
+		}
+		if (count > stats.peakAllocations) {
+			stats.peakAllocations = count;
+		}
+	}
+
+	/** Moves a block that was resized without allocating from its old size class to its new size class. */
+	void RecordResize(const size_t OldSize, const size_t NewSize) {
+		--classLive[HighestBit(OldSize)];
+		const size_t Class = HighestBit(NewSize);
+		if (++classLive[Class] > stats.classPeaks[Class]) {
+			stats.classPeaks[Class] = classLive[Class];
+		}
+		RecordPeaks();
+	}
+
+	/** Adds the time since the given start to the given latency histogram. */
+	static void RecordLatency(size_t* Histogram, const std::chrono::steady_clock::time_point Start) {
+		const auto Elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Start).count();
+		const size_t Bucket = Elapsed > 0 ? HighestBit(static_cast<size_t>(Elapsed)) : 0;
+		++Histogram[Bucket < MemHeapStats::LATENCIES ? Bucket : MemHeapStats::LATENCIES - 1];
+	}
+#endif
 
 public:
 
 	// CONSTRUCTORS AND DESTRUCTOR
 
 	/** Default constructor. */
-	MemHeap(const bool ZeroMemory = false) : usage(0), memory(), blocks() {
+	MemHeap(const bool ZeroMemory = false) : usage(0), count(0), memory(), firstMap(0), secondMaps(), lists(), marks()
+#if MEMHEAP_POOLS
+		, pools(), partial()
+#endif
+#if MEMHEAP_STATS
+		, stats(), classLive()
+#endif
+	{
 		if (ZeroMemory) {
 			std::memset(memory, 0, SIZE);
 		}
+		Block* First = reinterpret_cast<Block*>(memory);
+		First->size = (CAPACITY - HEADER) | FREE;
+		First->used = 0;
+		Insert(First);
 	}
 
 	/** Delete copy constructor. */
@@ -67,8 +972,8 @@ public:
 
 	/** Destructor. */
 	~MemHeap() {
-		if (blocks.size() > 0) {
-			std::cerr << "\n\nWARNING: Heap leaked " << blocks.size() << (blocks.size() == 1 ? " pointer on destruction!" : " pointers on destruction!") << std::endl;
+		if (count > 0) {
+			std::cerr << "\n\nWARNING: Heap leaked " << count << (count == 1 ? " pointer on destruction!" : " pointers on destruction!") << std::endl;
 		}
 	}
 
@@ -91,7 +996,7 @@ public:
 
 	/** Returns the current number of dynamic allocations. */
 	size_t Allocations() const {
-		return blocks.size();
+		return count;
 	}
 
 	/** Returns the total number of bytes currently being used. */
@@ -104,14 +1009,67 @@ public:
 		return SIZE - usage;
 	}
 
-	/** Returns whether the given pointer was allocated by this heap. */
+	/** Returns whether the given pointer was allocated by this heap and has not been freed. */
 	bool IsAllocated(void* Pointer) const {
-		return blocks.count(Pointer) != 0;
+#if MEMHEAP_POOLS
+		if (PoolOf(Pointer) != nullptr) {
+			return true;
+		}
+#endif
+		return Find(Pointer) != nullptr;
 	}
 
-	/** Returns the size of the given pointer's memory or zero if it was not allocated. */
+	/** Returns the size of the given pointer's memory or zero if it was not allocated. Pooled blocks return their block size. */
 	size_t SizeOf(void* Pointer) const {
-		return blocks.count(Pointer) ? blocks.at(Pointer) : 0;
+#if MEMHEAP_POOLS
+		const Pool* Page = PoolOf(Pointer);
+		if (Page != nullptr) {
+			return Page->slot;
+		}
+#endif
+		const Block* Current = Find(Pointer);
+		return Current != nullptr ? Current->used : 0;
+	}
+
+	/**
+	 * Returns the size of the given allocated pointer's memory without checking it. Pooled blocks return their block size.<br/>
+	 * Only reads the pointer's own header or pool page, so it is safe while other threads use this heap under a lock.
+	 */
+	size_t SizeOfUnchecked(void* Pointer) const {
+#if MEMHEAP_POOLS
+		const Pool* Page = PageOf(Pointer);
+		if (Page->slot != 0) {
+			return Page->slot;
+		}
+#endif
+		return reinterpret_cast<const Block*>(static_cast<uint8_t*>(Pointer) - HEADER)->used;
+	}
+
+	/**
+	 * Returns whether the given pointer was allocated by this heap and has not been freed.<br/>
+	 * Only reads the pointer's own mark and pool page, so it is safe while other threads use this heap under a lock.
+	 */
+	bool IsAllocatedUnlocked(void* Pointer) const {
+#if MEMHEAP_POOLS
+		if (Owns(Pointer)) {
+			const Pool* Page = PageOf(Pointer);
+			if (Page->slot != 0) {
+				const size_t Offset = reinterpret_cast<uintptr_t>(Pointer) & (PAGE - 1);
+				return Offset % Page->slot == 0 && Offset < PAGE_USABLE && IsMarked(Page->allocated, Offset / Page->slot);
+			}
+		}
+#endif
+		return Find(Pointer) != nullptr;
+	}
+
+	/** Returns whether the given pointer points into this heap's memory. */
+	bool Owns(void* Pointer) const {
+		return static_cast<const uint8_t*>(Pointer) >= memory && static_cast<const uint8_t*>(Pointer) < memory + SIZE;
+	}
+
+	/** Returns the alignment of each pointer allocated by this heap. Pooled blocks smaller than this are aligned to their own size. */
+	static constexpr size_t Alignment() {
+		return ALIGNMENT;
 	}
 
 	/** Returns whether the given blocks of memory overlap. */
@@ -123,76 +1081,79 @@ public:
 	}
 
 	/** Logs the current state of this heap. */
-	void Dump() const {
-		std::cout << "HEAP DUMP\n" << blocks.size() << (blocks.size() == 1 ? " ALLOCATED BLOCK\n" : " ALLOCATED BLOCKS\n");
-		for (auto& Block : blocks) {
-			std::cout << Block.first << " - " << Block.second << (Block.second == 1 ? " byte\n" : " bytes\n");
+	void Dump() {
+		std::cout << "HEAP DUMP\n" << count << (count == 1 ? " ALLOCATED BLOCK\n" : " ALLOCATED BLOCKS\n");
+		for (Block* Current = reinterpret_cast<Block*>(memory); Current != nullptr; Current = Next(Current)) {
+			if ((Current->size & FREE) == 0) {
+#if MEMHEAP_POOLS
+				const Pool* Page = PageOf(Data(Current));
+				if (Page->slot != 0) {
+					std::cout << static_cast<void*>(Data(Current)) << " - pool of " << Page->live << " / " << PAGE_USABLE / Page->slot << " " << Page->slot << " byte blocks\n";
+					continue;
+				}
+#endif
+				std::cout << static_cast<void*>(Data(Current)) << " - " << Current->used << (Current->used == 1 ? " byte\n" : " bytes\n");
+			}
 		}
 		std::cout << "TOTAL: " << usage << " / " << SIZE << (SIZE == 1 ? " byte" : " bytes") << std::endl;
 	}
 
+#if MEMHEAP_STATS
+	// STATISTICS
 
-	// ALLOCATION
-
-	/** Allocates a new pointer to raw memory of the given size. */
-	void* Malloc(const size_t Size) {
-		if (Size == 0) {
-#if MEMHEAP_THROWS
-			std::cerr << "\n\nERROR: Allocating zero bytes of memory!" << std::endl;
-			throw std::runtime_error("ERROR: Allocating zero bytes of memory!");
-#else
-			return nullptr;
-#endif
-		}
-		if (Size > SIZE) {
-#if MEMHEAP_THROWS
-			std::cerr << "\n\nERROR: Allocating more memory than the heap!" << std::endl;
-			throw std::runtime_error("ERROR: Allocating more memory than the heap!");
-#else
-			return nullptr;
-#endif
-		}
-		uint8_t* NextBlock = memory;
-		bool Success = NextBlock + Size <= memory + SIZE;
-		if (Success) {
-			for (auto& Block : blocks) {
-				if (DoesMemoryOverlap(NextBlock, Size, Block.first, Block.second)) {
-					Success = false;
-					break;
+	/** Returns the recorded allocation statistics, with the current free space measured by walking every block. */
+	MemHeapStats Stats() {
+		MemHeapStats Result = stats;
+		Result.usage = usage;
+		Result.allocations = count;
+		for (Block* Current = reinterpret_cast<Block*>(memory); Current != nullptr; Current = Next(Current)) {
+			if ((Current->size & FREE) != 0) {
+				const size_t Bytes = SizeOf(Current);
+				Result.freeBytes += Bytes;
+				++Result.freeBlocks;
+				if (Bytes > Result.largestFreeBlock) {
+					Result.largestFreeBlock = Bytes;
 				}
 			}
-			if (Success) {
-				blocks.emplace(NextBlock, Size);
-				usage += Size;
-				return NextBlock;
-			}
 		}
-		for (auto& Block1 : blocks) {
-			NextBlock = static_cast<uint8_t*>(Block1.first) + Block1.second;
-			Success = NextBlock + Size <= memory + SIZE;
-			if (Success) {
-				for (auto& Block2 : blocks) {
-					if (Block1.first == Block2.first) {
-						continue;
-					}
-					if (DoesMemoryOverlap(NextBlock, Size, Block2.first, Block2.second)) {
-						Success = false;
-						break;
-					}
-				}
-				if (Success) {
-					blocks.emplace(NextBlock, Size);
-					usage += Size;
-					return NextBlock;
-				}
-			}
+		Result.fragmentation = Result.freeBytes != 0 ? 1.0 - static_cast<double>(Result.largestFreeBlock) / static_cast<double>(Result.freeBytes) : 0.0;
+		return Result;
+	}
+
+	/** Returns the recorded allocation statistics as JSON. */
+	std::string StatsJson() {
+		return Stats().ToJson();
+	}
+
+	/** Clears the recorded counters and histograms. Peaks restart from the current usage. */
+	void ResetStats() {
+		stats = MemHeapStats();
+		RecordPeaks();
+		for (size_t Class = 0; Class < MemHeapStats::CLASSES; ++Class) {
+			stats.classPeaks[Class] = classLive[Class];
 		}
-#if MEMHEAP_THROWS
-		std::cerr << "\n\nERROR: Out of heap memory!" << std::endl;
-		throw std::runtime_error("ERROR: Out of heap memory!");
-#else
-		return nullptr;
-#endif
+	}
+#endif	// MEMHEAP_STATS
+
+
+	// ALLOCATION
+
+	/** Allocates a new pointer to raw memory of the given size. */
+	void* Malloc(const size_t Size) {
+		return Reserve(Size, 1, true);
+	}
+
+	/**
+	 * Allocates a new pointer to raw memory of the given size whose address is a multiple of the given power of two.<br/>
+	 * Alignments above Alignment() split the skipped bytes off as a free block. Realloc() does not keep alignments above Alignment().
+	 */
+	void* AlignedMalloc(const size_t Size, const size_t Align) {
+		return Reserve(Size, Align, true);
+	}
+
+	/** Allocates a new pointer to raw memory of the given size and alignment, or returns nullptr without an error if it cannot. */
+	void* TryMalloc(const size_t Size, const size_t Align = 1) {
+		return Size != 0 && Align != 0 && (Align & (Align - 1)) == 0 ? Allocate(Size, Align) : nullptr;
 	}
 
 	/**
@@ -220,13 +1181,20 @@ public:
 
 	/**
 	 * Reallocates the given pointer to hold the given size.<br/>
-	 * This is done either by expanding, shrinking, or moving the given pointer's block of raw memory.
+	 * Shrinking frees the end of the block. Growing first extends the block into the free block after it, then into the free
+	 * block before it, and only moves the memory to a new block if neither neighbor has room. Pooled blocks move when their size class changes.
 	 */
 	void* Realloc(void* Pointer, const size_t NewSize) {
 		if (Pointer == nullptr) {
 			return Malloc(NewSize);
 		}
-		if (!blocks.count(Pointer)) {
+		Block* Current = Find(Pointer);
+#if MEMHEAP_POOLS
+		Pool* Page = Current == nullptr ? PoolOf(Pointer) : nullptr;
+#else
+		const void* Page = nullptr;
+#endif
+		if (Current == nullptr && Page == nullptr) {
 #if MEMHEAP_THROWS
 			std::cerr << "\n\nERROR: Reallocating memory not owned by this heap!" << std::endl;
 			throw std::runtime_error("ERROR: Reallocating memory not owned by this heap!");
@@ -242,53 +1210,67 @@ public:
 			return nullptr;
 #endif
 		}
-		size_t& Size = blocks.at(Pointer);
-		if (NewSize == Size) {
-			return Pointer;
-		}
-		if (NewSize < Size) {
-			Size = NewSize;
-			return Pointer;
-		}
-		else {
-			for (auto& Block : blocks) {
-				if (Pointer != Block.first && DoesMemoryOverlap(Pointer, NewSize, Block.first, Block.second)) {
-					uint8_t* NewPointer = static_cast<uint8_t*>(Malloc(NewSize));
-#if MEMHEAP_THROWS
-					std::memcpy(NewPointer, Pointer, Size);
-					blocks.erase(Pointer);
-					blocks.emplace(NewPointer, NewSize);
-					return NewPointer;
-#else
-					if (NewPointer != nullptr) {
-						std::memcpy(NewPointer, Pointer, Size);
-						blocks.erase(Pointer);
-						blocks.emplace(NewPointer, NewSize);
-						return NewPointer;
-					}
-					else {
-						return Pointer;
-					}
+#if MEMHEAP_POOLS
+		if (Page != nullptr) {
+			if (NewSize <= POOL_MAX && (POOL_MIN << PoolClass(NewSize)) == Page->slot) {
+#if MEMHEAP_STATS
+				++stats.reallocsInPlace;
 #endif
-				}
+				return Pointer;
 			}
-			if (static_cast<uint8_t*>(Pointer) + NewSize > memory + SIZE) {
-#if MEMHEAP_THROWS
-				std::cerr << "\n\nERROR: Out of heap memory!" << std::endl;
-				throw std::runtime_error("ERROR: Out of heap memory!");
-#else
+			const size_t OldSize = Page->slot;
+			void* NewPointer = Malloc(NewSize);
+#if !MEMHEAP_THROWS
+			if (NewPointer == nullptr) {
+				return Pointer;
+			}
+#endif
+			std::memcpy(NewPointer, Pointer, OldSize < NewSize ? OldSize : NewSize);
+			Free(Pointer);
+#if MEMHEAP_STATS
+			++stats.reallocsMoved;
+#endif
+			return NewPointer;
+		}
+#endif
+		if (NewSize <= SIZE) {
+#if MEMHEAP_STATS
+			const size_t OldSize = Current->used;
+#endif
+			if (ResizeInPlace(Current, NewSize)) {
+#if MEMHEAP_STATS
+				++stats.reallocsInPlace;
+				RecordResize(OldSize, NewSize);
+#endif
 				return Pointer;
+			}
+			Block* Moved = ResizeBackward(Current, NewSize);
+			if (Moved != nullptr) {
+#if MEMHEAP_STATS
+				++stats.reallocsMoved;
+				RecordResize(OldSize, NewSize);
 #endif
+				return Data(Moved);
 			}
-			Size = NewSize;
+		}
+		void* NewPointer = Malloc(NewSize);
+#if !MEMHEAP_THROWS
+		if (NewPointer == nullptr) {
 			return Pointer;
 		}
+#endif
+		std::memcpy(NewPointer, Pointer, Current->used < NewSize ? Current->used : NewSize);
+		Free(Pointer);
+#if MEMHEAP_STATS
+		++stats.reallocsMoved;
+#endif
+		return NewPointer;
 	}
 
-	/** Allocates a new pointer of the given type after calling its constructor with the given arguments. */
+	/** Allocates a new pointer of the given type, aligned for the type, after calling its constructor with the given arguments. */
 	template<typename Type, typename ... ArgumentTypes>
 	Type* New(ArgumentTypes&&... Arguments) {
-		Type* Pointer = static_cast<Type*>(Malloc(sizeof(Type)));
+		Type* Pointer = static_cast<Type*>(AlignedMalloc(sizeof(Type), alignof(Type)));
 #if !MEMHEAP_THROWS
 		if (Pointer == nullptr) {
 			return nullptr;
@@ -297,13 +1279,13 @@ public:
 		return new (Pointer) Type(std::forward<ArgumentTypes>(Arguments)...);
 	}
 
-	/** Allocates a new pointer to an array of the given type after default constructing each element. */
+	/** Allocates a new pointer to an array of the given type, aligned for the type, after default constructing each element. Arrays are never pooled. */
 	template<typename Type>
 	Type* NewArray(const size_t Count) {
 		if (Count == 0) {
 			return nullptr;
 		}
-		Type* Pointer = static_cast<Type*>(Malloc(sizeof(Type) * Count));
+		Type* Pointer = static_cast<Type*>(Reserve(sizeof(Type) * Count, alignof(Type), false));
 #if !MEMHEAP_THROWS
 		if (Pointer == nullptr) {
 			return nullptr;
@@ -321,9 +1303,22 @@ public:
 	/** Frees the given pointer's memory from this heap. */
 	void Free(void* Pointer) {
 		if (Pointer != nullptr) {
-			if (blocks.count(Pointer)) {
-				usage -= blocks.at(Pointer);
-				blocks.erase(Pointer);
+#if MEMHEAP_STATS
+			const auto Start = std::chrono::steady_clock::now();
+#endif
+			const size_t Bytes = Release(Pointer);
+			if (Bytes != 0) {
+#if MEMHEAP_STATS
+				const size_t Class = HighestBit(Bytes);
+				++stats.frees;
+				++stats.classFrees[Class];
+				--classLive[Class];
+#endif
+				usage -= Bytes;
+				--count;
+#if MEMHEAP_STATS
+				RecordLatency(stats.freeLatency, Start);
+#endif
 			}
 #if MEMHEAP_THROWS
 			else {
@@ -338,9 +1333,9 @@ public:
 	template<typename Type>
 	void Delete(Type* Pointer) {
 		if (Pointer != nullptr) {
-			if (blocks.count(Pointer)) {
+			if (IsAllocated(Pointer)) {
 				Pointer->~Type();
-				blocks.erase(Pointer);
+				Free(Pointer);
 			}
 #if MEMHEAP_THROWS
 			else {
@@ -355,12 +1350,13 @@ public:
 	template<typename Type>
 	void DeleteArray(Type* Pointer) {
 		if (Pointer != nullptr) {
-			if (blocks.count(Pointer)) {
-				const size_t Count = blocks.at(Pointer) / sizeof(Type);
+			const Block* Current = Find(Pointer);
+			if (Current != nullptr) {
+				const size_t Count = Current->used / sizeof(Type);
 				for (size_t Index = 0; Index < Count; ++Index) {
 					Pointer[Index].~Type();
 				}
-				blocks.erase(Pointer);
+				Free(Pointer);
 			}
 #if MEMHEAP_THROWS
 			else {
@@ -373,9 +1369,440 @@ public:
 };
 
 
+// MEMORY HEAP CACHE
+
+/**
+ * A thread-safe front end for a Memory Heap that caches small blocks on each thread.<br/>
+ * Each thread keeps a magazine of free blocks for each size up to MEMHEAP_CACHE_MAX bytes. Malloc and Free use the calling
+ * thread's magazines without locking, and only lock the heap to refill or drain a magazine in batches, or for larger sizes.
+ * Once cached, every thread must use the heap through this cache. Cached blocks stay allocated in the heap until flushed.
+ */
+template<size_t SIZE = MEMHEAP_DEFAULT_SIZE>
+class MemHeapCache final {
+
+	// SIZE CLASSES
+
+	/** The alignment and spacing of each cached size. */
+	static constexpr size_t ALIGNMENT = MemHeap<SIZE>::Alignment();
+
+	/** The number of cached sizes. */
+	static constexpr size_t CLASSES = MEMHEAP_CACHE_MAX / ALIGNMENT;
+	static_assert(CLASSES != 0, "ERROR: The heap cache must cache at least one size!");
+
+	/** The number of blocks each magazine can hold. */
+	static constexpr size_t DEPTH = MEMHEAP_CACHE_DEPTH;
+	static_assert(DEPTH >= 2, "ERROR: The heap cache must cache at least two blocks of each size!");
+
+	/** The number of blocks moved between a magazine and the heap at once. */
+	static constexpr size_t BATCH = DEPTH / 2;
+
+
+	// MAGAZINES
+
+	/** The free blocks of one size cached by one thread. */
+	struct Magazine final {
+		/** The number of cached blocks. */
+		size_t count;
+
+		/** Each cached block, oldest first. */
+		void* blocks[DEPTH];
+	};
+
+	/** The blocks cached by one thread. */
+	struct ThreadCache final {
+		/** The cache these blocks belong to, or nullptr. */
+		MemHeapCache* owner;
+
+		/** The magazine of each size. */
+		Magazine magazines[CLASSES];
+
+		/** Default constructor. */
+		ThreadCache() : owner(nullptr), magazines() {
+		}
+
+		/** Destructor. Returns every cached block when the thread exits. */
+		~ThreadCache() {
+			if (owner != nullptr) {
+				owner->Drain(*this);
+			}
+		}
+	};
+
+	/** Returns the blocks cached by the current thread. */
+	static ThreadCache& CurrentThread() {
+		static thread_local ThreadCache Current;
+		return Current;
+	}
+
+
+	// DATA
+
+	/** The heap that blocks are allocated from. */
+	MemHeap<SIZE>& heap;
+
+	/** Guards the heap. */
+	std::mutex lock;
+
+
+	// MAGAZINES
+
+	/** Returns the index of the magazine of the given nonzero cached size. */
+	static size_t ClassOf(const size_t Size) {
+		return (Size + ALIGNMENT - 1) / ALIGNMENT - 1;
+	}
+
+	/** Returns the current thread's cache, first returning its blocks if it belonged to another cache. */
+	ThreadCache& Local() {
+		ThreadCache& Current = CurrentThread();
+		if (Current.owner != this) {
+			if (Current.owner != nullptr) {
+				Current.owner->Drain(Current);
+			}
+			Current.owner = this;
+		}
+		return Current;
+	}
+
+	/** Returns every block of the given thread's cache to the heap. */
+	void Drain(ThreadCache& Current) {
+		std::lock_guard<std::mutex> Guard(lock);
+		for (Magazine& Blocks : Current.magazines) {
+			for (size_t Index = 0; Index < Blocks.count; ++Index) {
+				heap.Free(Blocks.blocks[Index]);
+			}
+			Blocks.count = 0;
+		}
+	}
+
+	/** Allocates a batch of blocks of the given magazine's size from the heap. Returns false if none fit. */
+	bool Refill(Magazine& Blocks, const size_t Class) {
+		std::lock_guard<std::mutex> Guard(lock);
+		while (Blocks.count < BATCH) {
+			void* Pointer = heap.TryMalloc((Class + 1) * ALIGNMENT);
+			if (Pointer == nullptr) {
+				break;
+			}
+			Blocks.blocks[Blocks.count++] = Pointer;
+		}
+		return Blocks.count != 0;
+	}
+
+	/** Frees a batch of the given magazine's oldest blocks to the heap. */
+	void Release(Magazine& Blocks) {
+		{
+			std::lock_guard<std::mutex> Guard(lock);
+			for (size_t Index = 0; Index < BATCH; ++Index) {
+				heap.Free(Blocks.blocks[Index]);
+			}
+		}
+		Blocks.count -= BATCH;
+		std::memmove(Blocks.blocks, Blocks.blocks + BATCH, Blocks.count * sizeof(void*));
+	}
+
+public:
+
+	// CONSTRUCTORS AND DESTRUCTOR
+
+	/** Constructs a cache for the given heap. */
+	MemHeapCache(MemHeap<SIZE>& Heap) : heap(Heap), lock() {
+	}
+
+	/** Delete copy constructor. */
+	MemHeapCache(const MemHeapCache&) = delete;
+
+	/** Delete move constructor. */
+	MemHeapCache(MemHeapCache&&) noexcept = delete;
+
+	/** Destructor. Flushes the current thread. Every other thread that used this cache must have exited or flushed. */
+	~MemHeapCache() {
+		Flush();
+	}
+
+
+	// OPERATORS
+
+	/** Delete copy assignment operator. */
+	MemHeapCache& operator=(const MemHeapCache&) = delete;
+
+	/** Delete move assignment operator. */
+	MemHeapCache& operator=(MemHeapCache&&) noexcept = delete;
+
+
+	// CACHE
+
+	/** Returns every block cached by the current thread to the heap. */
+	void Flush() {
+		ThreadCache& Current = CurrentThread();
+		if (Current.owner == this) {
+			Drain(Current);
+			Current.owner = nullptr;
+		}
+	}
+
+	/** Calls the given function with the heap while holding its lock, and returns its result. */
+	template<typename Function>
+	auto Locked(Function&& Call) {
+		std::lock_guard<std::mutex> Guard(lock);
+		return Call(heap);
+	}
+
+
+	// ALLOCATION
+
+	/**
+	 * Allocates a new pointer to raw memory of the given size.<br/>
+	 * Sizes up to MEMHEAP_CACHE_MAX are rounded up to a multiple of the heap's alignment and usually taken from the current thread's cache.
+	 */
+	void* Malloc(const size_t Size) {
+		if (Size == 0 || Size > CLASSES * ALIGNMENT) {
+			std::lock_guard<std::mutex> Guard(lock);
+			return heap.Malloc(Size);
+		}
+		const size_t Class = ClassOf(Size);
+		ThreadCache& Current = Local();
+		Magazine& Blocks = Current.magazines[Class];
+		if (Blocks.count == 0 && !Refill(Blocks, Class)) {
+			Drain(Current);
+			std::lock_guard<std::mutex> Guard(lock);
+			return heap.Malloc((Class + 1) * ALIGNMENT);
+		}
+		return Blocks.blocks[--Blocks.count];
+	}
+
+	/** Allocates a new pointer to raw memory of the given size and power of two alignment. Alignments above the heap's always lock the heap. */
+	void* AlignedMalloc(const size_t Size, const size_t Align) {
+		if (Align <= ALIGNMENT) {
+			return Malloc(Size);
+		}
+		std::lock_guard<std::mutex> Guard(lock);
+		return heap.AlignedMalloc(Size, Align);
+	}
+
+	/**
+	 * Allocates a new pointer to raw memory of the given size and count.<br/>
+	 * The new block of memory is zero-initialized and stored contiguously.
+	 */
+	void* Calloc(const size_t Count, const size_t Size) {
+		if (Size != 0 && Count > SIZE / Size) {
+			std::lock_guard<std::mutex> Guard(lock);
+			return heap.Calloc(Count, Size);
+		}
+		void* Pointer = Malloc(Count * Size);
+#if !MEMHEAP_THROWS
+		if (Pointer == nullptr) {
+			return nullptr;
+		}
+#endif
+		return std::memset(Pointer, 0, Count * Size);
+	}
+
+	/** Reallocates the given pointer to hold the given size. Always locks the heap. */
+	void* Realloc(void* Pointer, const size_t NewSize) {
+		if (Pointer == nullptr) {
+			return Malloc(NewSize);
+		}
+		std::lock_guard<std::mutex> Guard(lock);
+		return heap.Realloc(Pointer, NewSize);
+	}
+
+	/** Allocates a new pointer of the given type, aligned for the type, after calling its constructor with the given arguments. */
+	template<typename Type, typename ... ArgumentTypes>
+	Type* New(ArgumentTypes&&... Arguments) {
+		Type* Pointer = static_cast<Type*>(AlignedMalloc(sizeof(Type), alignof(Type)));
+#if !MEMHEAP_THROWS
+		if (Pointer == nullptr) {
+			return nullptr;
+		}
+#endif
+		return new (Pointer) Type(std::forward<ArgumentTypes>(Arguments)...);
+	}
+
+	/** Allocates a new pointer to an array of the given type after default constructing each element. Always locks the heap. */
+	template<typename Type>
+	Type* NewArray(const size_t Count) {
+		std::lock_guard<std::mutex> Guard(lock);
+		return heap.template NewArray<Type>(Count);
+	}
+
+
+	// DEALLOCATION
+
+	/**
+	 * Frees the given pointer's memory.<br/>
+	 * Blocks of exactly a cached size are kept in the current thread's cache without locking once their mark shows they are allocated.
+	 * Blocks that are already cached stay marked, so freeing one of them twice is not caught.
+	 * Any other pointer, such as a block resized by Realloc() or one the heap never allocated, is returned to the heap, which rejects it if it is invalid.
+	 */
+	void Free(void* Pointer) {
+		if (Pointer == nullptr) {
+			return;
+		}
+		const size_t Size = heap.IsAllocatedUnlocked(Pointer) ? heap.SizeOfUnchecked(Pointer) : 0;
+		if (Size == 0 || Size > CLASSES * ALIGNMENT || Size % ALIGNMENT != 0) {
+			std::lock_guard<std::mutex> Guard(lock);
+			heap.Free(Pointer);
+			return;
+		}
+		Magazine& Blocks = Local().magazines[ClassOf(Size)];
+		if (Blocks.count == DEPTH) {
+			Release(Blocks);
+		}
+		Blocks.blocks[Blocks.count++] = Pointer;
+	}
+
+	/** Frees the given pointer to the given type's memory after calling its destructor. */
+	template<typename Type>
+	void Delete(Type* Pointer) {
+		if (Pointer != nullptr) {
+			Pointer->~Type();
+			Free(Pointer);
+		}
+	}
+
+	/** Frees the given pointer from NewArray() after calling each element's destructor. Always locks the heap. */
+	template<typename Type>
+	void DeleteArray(Type* Pointer) {
+		std::lock_guard<std::mutex> Guard(lock);
+		heap.DeleteArray(Pointer);
+	}
+};
+
+
+// MEMORY HEAP ALLOCATORS
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+/** A polymorphic memory resource that allocates from a Memory Heap, so std::pmr containers can use its fixed memory. Throws std::bad_alloc when the heap is full. */
+template<size_t SIZE = MEMHEAP_DEFAULT_SIZE>
+class MemHeapResource final : public std::pmr::memory_resource {
+
+	// DATA
+
+	/** The heap that memory is allocated from. */
+	MemHeap<SIZE>* heap;
+
+public:
+
+	// CONSTRUCTOR
+
+	/** Constructs a memory resource for the given heap. */
+	MemHeapResource(MemHeap<SIZE>& Heap) noexcept : heap(&Heap) {
+	}
+
+
+	// RESOURCE
+
+	/** Returns the heap that memory is allocated from. */
+	MemHeap<SIZE>& Heap() const noexcept {
+		return *heap;
+	}
+
+private:
+
+	// RESOURCE
+
+	/** Allocates the given number of bytes with the given alignment. */
+	void* do_allocate(const size_t Bytes, const size_t Alignment) override {
+		void* Pointer = heap->TryMalloc(Bytes != 0 ? Bytes : 1, Alignment);
+		if (Pointer == nullptr) {
+			throw std::bad_alloc();
+		}
+		return Pointer;
+	}
+
+	/** Frees the given memory. */
+	void do_deallocate(void* Pointer, size_t, size_t) override {
+		heap->Free(Pointer);
+	}
+
+	/** Returns whether the given resource allocates from the same heap. */
+	bool do_is_equal(const std::pmr::memory_resource& Other) const noexcept override {
+		const MemHeapResource* Resource = dynamic_cast<const MemHeapResource*>(&Other);
+		return Resource != nullptr && Resource->heap == heap;
+	}
+};
+#endif
+
+/** A stateful allocator that allocates objects of the given type from a Memory Heap, for standard containers. */
+template<typename Type, size_t SIZE = MEMHEAP_DEFAULT_SIZE>
+class MemHeapAllocator {
+	template<typename OtherType, size_t OTHER_SIZE>
+	friend class MemHeapAllocator;
+
+	// DATA
+
+	/** The heap that objects are allocated from. */
+	MemHeap<SIZE>* heap;
+
+public:
+
+	// TYPES
+
+	/** The type of object allocated. */
+	using value_type = Type;
+
+	/** The allocator for another type of object. */
+	template<typename OtherType>
+	struct rebind {
+		using other = MemHeapAllocator<OtherType, SIZE>;
+	};
+
+
+	// CONSTRUCTORS
+
+	/** Constructs an allocator for the given heap. */
+	MemHeapAllocator(MemHeap<SIZE>& Heap) noexcept : heap(&Heap) {
+	}
+
+	/** Constructs an allocator that shares another allocator's heap. */
+	template<typename OtherType>
+	MemHeapAllocator(const MemHeapAllocator<OtherType, SIZE>& Other) noexcept : heap(Other.heap) {
+	}
+
+
+	// OPERATORS
+
+	/** Returns whether both allocators allocate from the same heap. */
+	template<typename OtherType>
+	bool operator==(const MemHeapAllocator<OtherType, SIZE>& Other) const noexcept {
+		return heap == Other.heap;
+	}
+
+	/** Returns whether the allocators allocate from different heaps. */
+	template<typename OtherType>
+	bool operator!=(const MemHeapAllocator<OtherType, SIZE>& Other) const noexcept {
+		return heap != Other.heap;
+	}
+
+
+	// ALLOCATOR
+
+	/** Returns the heap that objects are allocated from. */
+	MemHeap<SIZE>& Heap() const noexcept {
+		return *heap;
+	}
+
+	/** Allocates uninitialized memory for the given number of objects, aligned for the type. Throws std::bad_alloc on failure. */
+	Type* allocate(const size_t Count) {
+		void* Pointer = Count <= SIZE / sizeof(Type) ? heap->TryMalloc(Count * sizeof(Type), alignof(Type)) : nullptr;
+		if (Pointer == nullptr) {
+			throw std::bad_alloc();
+		}
+		return static_cast<Type*>(Pointer);
+	}
+
+	/** Frees memory from allocate(). */
+	void deallocate(Type* Pointer, size_t) {
+		heap->Free(Pointer);
+	}
+};
+
+
 // STATIC VARIABLE INITIALIZATION
 
 #if MEMHEAP_SINGLETON
 /** The global instance of the Memory Heap. */
 MemHeap<> Heap;
+
+/** The global thread-caching front end of the Memory Heap. Use it instead of Heap when allocating from several threads. */
+MemHeapCache<> HeapCache(Heap);
 #endif	// MEMHEAP_SINGLETON
@@ -0,0 +1,119 @@
+// .cpp
+// Memory Heap Benchmarks
+// by Kyle Furey
+
+// Compares a Memory Heap Cache to a Memory Heap behind one mutex as threads are added.
+// Build with optimizations, such as: c++ -std=c++17 -O2 -pthread MemHeapBenchmark.cpp
+
+#define MEMHEAP_SINGLETON 0
+#include "MemHeap.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** The number of bytes of each benchmarked heap. */
+#define BENCHMARK_HEAP_SIZE (1 << 24)
+
+/** The number of allocations and frees each thread makes. */
+#define BENCHMARK_OPERATIONS 1000000
+
+/** The number of blocks each thread keeps allocated at once. */
+#define BENCHMARK_LIVE 64
+
+
+// BENCHMARK
+
+/** Returns the next pseudorandom number of the given state. */
+static uint32_t NextRandom(uint32_t& State) {
+	State ^= State << 13;
+	State ^= State >> 17;
+	State ^= State << 5;
+	return State;
+}
+
+/**
+ * Runs the given number of threads that each allocate blocks of 16 to 256 bytes with the given allocate function and free
+ * them in the order they were allocated with the given free function, and returns the allocations per second across every thread.
+ */
+template<typename AllocateFunction, typename FreeFunction>
+static double BenchmarkThreads(const size_t Threads, AllocateFunction&& Allocate, FreeFunction&& Free) {
+	std::atomic<size_t> Ready(0);
+	std::atomic<bool> Started(false);
+	std::vector<std::thread> Workers;
+	for (size_t Thread = 0; Thread < Threads; ++Thread) {
+		Workers.emplace_back([&, Thread]() {
+			uint32_t State = static_cast<uint32_t>(Thread) * 2654435761u + 1;
+			void* Live[BENCHMARK_LIVE] = {};
+			Ready.fetch_add(1);
+			while (!Started.load()) {
+				std::this_thread::yield();
+			}
+			for (size_t Operation = 0; Operation < BENCHMARK_OPERATIONS; ++Operation) {
+				void*& Slot = Live[Operation % BENCHMARK_LIVE];
+				if (Slot != nullptr) {
+					Free(Slot);
+				}
+				Slot = Allocate((NextRandom(State) % 16 + 1) * 16);
+				static_cast<char*>(Slot)[0] = 1;
+			}
+			for (void* Pointer : Live) {
+				if (Pointer != nullptr) {
+					Free(Pointer);
+				}
+			}
+		});
+	}
+	while (Ready.load() != Threads) {
+		std::this_thread::yield();
+	}
+	const auto Start = std::chrono::steady_clock::now();
+	Started.store(true);
+	for (std::thread& Worker : Workers) {
+		Worker.join();
+	}
+	const double Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+	return static_cast<double>(Threads) * BENCHMARK_OPERATIONS / Elapsed;
+}
+
+
+// MAIN
+
+/** The heap behind one mutex. */
+static MemHeap<BENCHMARK_HEAP_SIZE> LockedHeap;
+
+/** The heap behind a cache. */
+static MemHeap<BENCHMARK_HEAP_SIZE> CachedHeap;
+
+/** Entry point of the program. */
+int main() {
+	std::mutex Lock;
+	MemHeapCache<BENCHMARK_HEAP_SIZE> Cache(CachedHeap);
+
+	std::vector<size_t> Counts = { 1, 2, 4, 8 };
+	const size_t Cores = std::thread::hardware_concurrency();
+	if (Cores > 8) {
+		Counts.push_back(Cores);
+	}
+
+	std::printf("MemHeap, %d allocations per thread of 16 to 256 bytes, %d live per thread\n\n", BENCHMARK_OPERATIONS, BENCHMARK_LIVE);
+	std::printf("%8s %20s %20s %8s\n", "Threads", "Locked (allocs/s)", "Cached (allocs/s)", "Speedup");
+	for (const size_t Threads : Counts) {
+		const double Locked = BenchmarkThreads(Threads, [&](const size_t Size) {
+			std::lock_guard<std::mutex> Guard(Lock);
+			return LockedHeap.Malloc(Size);
+		}, [&](void* Pointer) {
+			std::lock_guard<std::mutex> Guard(Lock);
+			LockedHeap.Free(Pointer);
+		});
+		const double Cached = BenchmarkThreads(Threads, [&](const size_t Size) {
+			return Cache.Malloc(Size);
+		}, [&](void* Pointer) {
+			Cache.Free(Pointer);
+		});
+		std::printf("%8zu %20.0f %20.0f %7.2fx\n", Threads, Locked, Cached, Cached / Locked);
+	}
+	return LockedHeap.Allocations() == 0 && CachedHeap.Allocations() == 0 ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+// .cpp
+// Memory Heap Fragmentation Benchmark
+// by Kyle Furey
+
+// Churns a Memory Heap with random allocations and frees and reports how its free space fragments over time.
+// Build with optimizations, such as: c++ -std=c++17 -O2 MemHeapFragmentationBenchmark.cpp
+
+#define MEMHEAP_SINGLETON 0
+#define MEMHEAP_STATS 1
+#include "MemHeap.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+/** The number of bytes of the benchmarked heap. */
+#define BENCHMARK_HEAP_SIZE (1 << 20)
+
+/** The number of allocations or frees made. */
+#define BENCHMARK_STEPS 2000000
+
+/** The number of steps between each report. */
+#define BENCHMARK_REPORT_STEPS 200000
+
+/** The fraction of the heap the churn tries to keep allocated. */
+#define BENCHMARK_TARGET_USAGE 0.75
+
+
+// BENCHMARK
+
+/** Returns the next pseudorandom number of the given state. */
+static uint32_t NextRandom(uint32_t& State) {
+	State ^= State << 13;
+	State ^= State >> 17;
+	State ^= State << 5;
+	return State;
+}
+
+/** Returns a random allocation size: mostly small objects, some medium buffers, and a few large ones. */
+static size_t RandomSize(uint32_t& State) {
+	const uint32_t Kind = NextRandom(State) % 100;
+	if (Kind < 80) {
+		return NextRandom(State) % 256 + 1;
+	}
+	if (Kind < 98) {
+		return NextRandom(State) % 4096 + 257;
+	}
+	return NextRandom(State) % 32768 + 4353;
+}
+
+/** The heap being churned. */
+static MemHeap<BENCHMARK_HEAP_SIZE> Heap;
+
+
+// MAIN
+
+/** Entry point of the program. */
+int main() {
+	std::vector<void*> Live;
+	uint32_t State = 1;
+	size_t Failures = 0;
+
+	std::printf("MemHeap fragmentation, %d byte heap, %d steps, %.0f%% target usage\n\n", BENCHMARK_HEAP_SIZE, BENCHMARK_STEPS, BENCHMARK_TARGET_USAGE * 100);
+	std::printf("%10s %10s %10s %10s %12s %14s %9s\n", "Step", "Live", "Used", "Free", "Free blocks", "Largest free", "Frag");
+	const auto Start = std::chrono::steady_clock::now();
+	for (size_t Step = 1; Step <= BENCHMARK_STEPS; ++Step) {
+		const bool Allocate = Live.empty() || (Heap.Budget() > BENCHMARK_HEAP_SIZE * (1 - BENCHMARK_TARGET_USAGE) ? NextRandom(State) % 4 != 0 : NextRandom(State) % 4 == 0);
+		if (Allocate) {
+			void* Pointer = Heap.TryMalloc(RandomSize(State));
+			if (Pointer != nullptr) {
+				Live.push_back(Pointer);
+			}
+			else {
+				++Failures;
+			}
+		}
+		else {
+			const size_t Index = NextRandom(State) % Live.size();
+			Heap.Free(Live[Index]);
+			Live[Index] = Live.back();
+			Live.pop_back();
+		}
+		if (Step % BENCHMARK_REPORT_STEPS == 0) {
+			const MemHeapStats Stats = Heap.Stats();
+			std::printf("%10zu %10zu %10zu %10zu %12zu %14zu %8.1f%%\n", Step, Live.size(), Stats.usage, Stats.freeBytes, Stats.freeBlocks, Stats.largestFreeBlock, Stats.fragmentation * 100);
+		}
+	}
+	const double Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+	std::printf("\n%zu failed allocations, %.1f ns per step including reports\n", Failures, Elapsed * 1e9 / BENCHMARK_STEPS);
+
+	for (void* Pointer : Live) {
+		Heap.Free(Pointer);
+	}
+	const MemHeapStats Stats = Heap.Stats();
+	std::printf("After freeing everything: %zu free blocks, largest free block %zu bytes\n", Stats.freeBlocks, Stats.largestFreeBlock);
+	return Heap.Allocations() == 0 ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+// .cpp
+// Memory Heap Tests
+// by Kyle Furey
+
+#define MEMHEAP_SINGLETON 0
+#include "MemHeap.h"
+#include <cassert>
+#include <cstdio>
+
+
+// TESTS
+
+/** Tests that a block shrunk by Realloc() is never handed out of the cache as a larger block. */
+static void TestCacheRealloc() {
+	static MemHeap<1 << 16> Heap;
+	MemHeapCache<1 << 16> Cache(Heap);
+	char* Shrunk = static_cast<char*>(Cache.Realloc(Cache.Malloc(32), 20));
+	Cache.Free(Shrunk);
+	char* Reused = static_cast<char*>(Cache.Malloc(30));
+	assert(Heap.SizeOfUnchecked(Reused) >= 30);
+	for (int Index = 0; Index < 30; ++Index) {
+		Reused[Index] = static_cast<char>(Index);
+	}
+	char* Moved = static_cast<char*>(Cache.Realloc(Reused, 1000));
+	for (int Index = 0; Index < 30; ++Index) {
+		assert(Moved[Index] == static_cast<char>(Index));
+	}
+	Cache.Free(Moved);
+	Cache.Flush();
+	assert(Heap.Allocations() == 0);
+}
+
+/** Tests that a pointer into the middle of a block is never treated as an allocated block, even behind a convincing header. */
+static void TestInteriorPointer() {
+	static MemHeap<1 << 16> Heap;
+	size_t* Outer = static_cast<size_t*>(Heap.Malloc(1024));
+	size_t* Inner = Outer + 16;
+	Inner[-2] = 64;
+	Inner[-1] = 16;
+	assert(!Heap.IsAllocated(Inner));
+	assert(Heap.SizeOf(Inner) == 0);
+	bool Threw = false;
+	try {
+		Heap.Free(Inner);
+	}
+	catch (const std::runtime_error&) {
+		Threw = true;
+	}
+	assert(Threw);
+	Threw = false;
+	try {
+		Heap.Realloc(Inner, 32);
+	}
+	catch (const std::runtime_error&) {
+		Threw = true;
+	}
+	assert(Threw);
+	assert(Heap.SizeOf(Outer) == 1024);
+	Heap.Free(Outer);
+	assert(Heap.Allocations() == 0);
+}
+
+/** Tests that the cache returns pointers it cannot find in the heap's marks to the heap, which rejects them, instead of caching them. */
+static void TestCacheInteriorPointer() {
+	static MemHeap<1 << 16> Heap;
+	MemHeapCache<1 << 16> Cache(Heap);
+	size_t* Outer = static_cast<size_t*>(Cache.Malloc(1024));
+	size_t* Inner = Outer + 16;
+	Inner[-2] = 64;
+	Inner[-1] = 64;
+	char* Small = static_cast<char*>(Cache.Malloc(16));
+	for (void* Pointer : { static_cast<void*>(Inner), static_cast<void*>(Small + 8) }) {
+		bool Threw = false;
+		try {
+			Cache.Free(Pointer);
+		}
+		catch (const std::runtime_error&) {
+			Threw = true;
+		}
+		assert(Threw);
+	}
+	void* Reused = Cache.Malloc(64);
+	assert(Reused != Inner);
+	Cache.Free(Reused);
+	Cache.Free(Small);
+	Cache.Free(Outer);
+	Cache.Flush();
+	assert(Heap.Allocations() == 0);
+}
+
+/** Tests that a block moved backward by Realloc() is found at its new address and not at its old one. */
+static void TestReallocBackward() {
+	static MemHeap<1 << 16> Heap;
+	void* Before = Heap.Malloc(512);
+	void* Current = Heap.Malloc(300);
+	void* After = Heap.Malloc(300);
+	Heap.Free(Before);
+	void* Moved = Heap.Realloc(Current, 700);
+	assert(Moved != Current);
+	assert(Heap.IsAllocated(Moved) && !Heap.IsAllocated(Current));
+	Heap.Free(Moved);
+	Heap.Free(After);
+	assert(Heap.Allocations() == 0);
+}
+
+/** Tests that freeing a small block twice is rejected, whether or not it was pooled. */
+static void TestDoubleFree() {
+	static MemHeap<1 << 16> Heap;
+	void* Pointer = Heap.Malloc(16);
+	Heap.Free(Pointer);
+	bool Threw = false;
+	try {
+		Heap.Free(Pointer);
+	}
+	catch (const std::runtime_error&) {
+		Threw = true;
+	}
+	assert(Threw);
+	assert(Heap.Allocations() == 0 && !Heap.IsAllocated(Pointer));
+	void* First = Heap.Malloc(16);
+	void* Second = Heap.Malloc(16);
+	assert(First != Second);
+	Heap.Free(First);
+	Heap.Free(Second);
+	assert(Heap.Allocations() == 0);
+}
+
+
+/** Entry point of the program. */
+int main() {
+	TestCacheRealloc();
+	TestInteriorPointer();
+	TestCacheInteriorPointer();
+	TestReallocBackward();
+	TestDoubleFree();
+	std::printf("MemHeap tests passed!\n");
+	return 0;
+}
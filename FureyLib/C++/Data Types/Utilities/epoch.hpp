@@ -0,0 +1,226 @@
+// .hpp
+// Epoch-Based Memory Reclamation
+// by Kyle Furey
+
+#pragma once
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+
+// EPOCH
+
+/**
+ * Epoch-based reclamation shared by the concurrent collections.<br/>
+ * Readers pin the current epoch while they read a published object. Writers retire replaced objects with the epoch they
+ * were replaced in, and delete them once every pinned reader entered in a later epoch. Readers never lock or wait.
+ */
+class epoch final {
+
+    // READERS
+
+    /** The maximum number of threads that each pin with their own slot. Other threads share one overflow counter. */
+    static constexpr size_t MAX_READERS = 128;
+
+    /** The epoch a reader thread pinned, or 0 if it is not reading. */
+    struct alignas(64) reader_slot final {
+
+        // DATA
+
+        /** The epoch the reader pinned, or 0 if it is not reading. */
+        std::atomic<uint64_t> pinned;
+
+        /** Whether a thread owns this slot. */
+        std::atomic<bool> used;
+
+
+        // CONSTRUCTOR
+
+        /** Constructs an unused slot. */
+        constexpr reader_slot() noexcept : pinned(0), used(false) {
+        }
+    };
+
+    /** The reader slot of each thread. */
+    static inline reader_slot readers[MAX_READERS];
+
+    /** The number of threads without a reader slot that are reading. While nonzero, nothing is reclaimed. */
+    alignas(64) static inline std::atomic<size_t> overflow{0};
+
+    /** The current epoch, which advances each time an object is retired. Never 0. */
+    alignas(64) static inline std::atomic<uint64_t> current{1};
+
+    /** The reader slot claimed by the current thread for its lifetime. */
+    struct registration final {
+
+        // DATA
+
+        /** The claimed slot, or nullptr if every slot was taken. */
+        reader_slot *slot;
+
+        /** The number of nested pins on this thread. */
+        size_t depth;
+
+
+        // CONSTRUCTOR AND DESTRUCTOR
+
+        /** Claims the first free reader slot. */
+        registration() noexcept : slot(nullptr), depth(0) {
+            for (reader_slot &reader : readers) {
+                bool expected = false;
+                if (!reader.used.load(std::memory_order_relaxed) && reader.used.compare_exchange_strong(expected, true)) {
+                    slot = &reader;
+                    break;
+                }
+            }
+        }
+
+        /** Releases the claimed reader slot. */
+        ~registration() {
+            if (slot != nullptr) {
+                slot->pinned.store(0);
+                slot->used.store(false);
+            }
+        }
+    };
+
+    /** Returns the registration of the current thread. */
+    static registration &current_thread() noexcept {
+        static thread_local registration thread;
+        return thread;
+    }
+
+public:
+
+    // GUARD
+
+    /** Pins the current epoch on this thread while it exists. Guards nest, and must be destroyed on the thread that made them. */
+    class guard final {
+    public:
+
+        // CONSTRUCTORS AND DESTRUCTOR
+
+        /** Pins the current epoch. Objects loaded after this point stay alive until the guard is destroyed. */
+        guard() noexcept {
+            registration &thread = current_thread();
+            if (thread.slot == nullptr) {
+                overflow.fetch_add(1);
+            }
+            else if (thread.depth++ == 0) {
+                thread.slot->pinned.store(current.load());
+            }
+        }
+
+        /** Delete copy constructor. */
+        guard(const guard &) = delete;
+
+        /** Unpins the epoch. */
+        ~guard() {
+            registration &thread = current_thread();
+            if (thread.slot == nullptr) {
+                overflow.fetch_sub(1, std::memory_order_release);
+            }
+            else if (--thread.depth == 0) {
+                thread.slot->pinned.store(0, std::memory_order_release);
+            }
+        }
+
+
+        // OPERATORS
+
+        /** Delete copy assignment operator. */
+        guard &operator=(const guard &) = delete;
+    };
+
+
+    // RETIRED
+
+    /** Objects that were replaced and are waiting until no reader can see them. Not thread safe: guard it with the writer lock. */
+    template <typename T>
+    class retired final {
+
+        // DATA
+
+        /** Each retired object and the epoch it was retired in. */
+        std::vector<std::pair<uint64_t, const T *>> objects;
+
+    public:
+
+        // CONSTRUCTORS AND DESTRUCTOR
+
+        /** Default constructor. */
+        retired() : objects() {
+        }
+
+        /** Delete copy constructor. */
+        retired(const retired &) = delete;
+
+        /** Deletes every retired object. No reader may still see them. */
+        ~retired() {
+            for (auto &pair : objects) {
+                delete pair.second;
+            }
+        }
+
+
+        // OPERATORS
+
+        /** Delete copy assignment operator. */
+        retired &operator=(const retired &) = delete;
+
+
+        // RETIRED
+
+        /** Returns the number of retired objects that have not been deleted. */
+        size_t size() const noexcept {
+            return objects.size();
+        }
+
+        /** Retires an object that was just unpublished, then deletes every retired object no reader can see. */
+        void retire(const T *object) {
+            objects.emplace_back(advance(), object);
+            reclaim();
+        }
+
+        /** Deletes every retired object no reader can see. */
+        void reclaim() noexcept {
+            const uint64_t safe = oldest();
+            size_t kept = 0;
+            for (size_t i = 0; i < objects.size(); ++i) {
+                if (objects[i].first < safe) {
+                    delete objects[i].second;
+                }
+                else {
+                    objects[kept++] = objects[i];
+                }
+            }
+            objects.resize(kept);
+        }
+    };
+
+
+    // EPOCH
+
+    /** Advances the current epoch and returns the epoch that just ended. Call after unpublishing an object. */
+    static uint64_t advance() noexcept {
+        return current.fetch_add(1);
+    }
+
+    /** Returns the oldest epoch any reader has pinned, or the current epoch if none are reading. Objects retired before it can be deleted. */
+    static uint64_t oldest() noexcept {
+        if (overflow.load() != 0) {
+            return 0;
+        }
+        uint64_t result = current.load();
+        for (const reader_slot &reader : readers) {
+            const uint64_t pinned = reader.pinned.load();
+            if (pinned != 0 && pinned < result) {
+                result = pinned;
+            }
+        }
+        return result;
+    }
+};
@@ -0,0 +1,342 @@
+// .hpp
+// Work-Stealing Thread Pool Type
+// by Kyle Furey
+
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <exception>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+
+// LATCH
+
+/** A single-use countdown that threads can wait on until it reaches zero. */
+class countdown_latch final {
+
+    // DATA
+
+    /** The remaining count. Only decremented while holding the lock. */
+    std::atomic<ptrdiff_t> counter;
+
+    /** Guards waiting and the final count down. */
+    std::mutex lock;
+
+    /** Signaled when the count reaches zero. */
+    std::condition_variable released;
+
+public:
+
+    // CONSTRUCTORS
+
+    /** Constructs a latch with the given count. */
+    explicit countdown_latch(const ptrdiff_t expected) : counter(expected), lock(), released() {
+    }
+
+    /** Delete copy constructor. */
+    countdown_latch(const countdown_latch &) = delete;
+
+
+    // OPERATORS
+
+    /** Delete copy assignment operator. */
+    countdown_latch &operator=(const countdown_latch &) = delete;
+
+
+    // LATCH
+
+    /** Decrements the count by the given amount, releasing every waiting thread once it reaches zero. */
+    void count_down(const ptrdiff_t amount = 1) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (counter.fetch_sub(amount, std::memory_order_acq_rel) == amount) {
+            released.notify_all();
+        }
+    }
+
+    /** Returns whether the count has reached zero without blocking. Call wait() before destroying the latch. */
+    bool try_wait() const noexcept {
+        return counter.load(std::memory_order_acquire) == 0;
+    }
+
+    /** Blocks until the count reaches zero. */
+    void wait() {
+        std::unique_lock<std::mutex> guard(lock);
+        released.wait(guard, [this]() {
+            return try_wait();
+        });
+    }
+
+    /** Decrements the count by the given amount and blocks until it reaches zero. */
+    void arrive_and_wait(const ptrdiff_t amount = 1) {
+        count_down(amount);
+        wait();
+    }
+};
+
+
+// WORKER POOL
+
+/**
+ * A fixed set of worker threads that run indexed tasks in parallel with the calling thread.<br/>
+ * Each worker owns a queue. Tasks are dealt across the queues, each worker runs its own queue newest first, and idle
+ * workers and the calling thread steal the oldest tasks of other queues. Tasks may run() nested jobs on the same pool.
+ */
+class worker_pool final {
+
+    // JOB
+
+    /** One call to run() in progress. */
+    struct job final {
+
+        // DATA
+
+        /** Calls the job's function with a task index. */
+        void (*call)(void *function, size_t index);
+
+        /** The job's function. */
+        void *function;
+
+        /** Counts down once per finished task. */
+        countdown_latch done;
+
+        /** Whether a task has thrown. */
+        std::atomic<bool> failed;
+
+        /** The exception of the first task that threw. */
+        std::exception_ptr error;
+
+
+        // CONSTRUCTOR
+
+        /** Constructs a job with the given number of tasks. */
+        job(void (*call)(void *, size_t), void *function, const size_t tasks) :
+            call(call), function(function), done(static_cast<ptrdiff_t>(tasks)), failed(false), error() {
+        }
+    };
+
+    /** One task of a job. */
+    struct task final {
+
+        // DATA
+
+        /** The job of this task. */
+        job *owner;
+
+        /** The index of this task. */
+        size_t index;
+    };
+
+    /** The tasks of one worker. */
+    struct alignas(64) queue final {
+
+        // DATA
+
+        /** Guards the tasks. */
+        std::mutex lock;
+
+        /** The tasks, oldest first. */
+        std::deque<task> tasks;
+    };
+
+
+    // DATA
+
+    /** The worker threads. */
+    std::vector<std::thread> threads;
+
+    /** The number of worker threads. Set before any worker starts. */
+    size_t workers;
+
+    /** The queue of each worker thread. */
+    std::unique_ptr<queue[]> queues;
+
+    /** The number of queued tasks across every queue. */
+    std::atomic<size_t> queued;
+
+    /** Guards sleeping and stopping. */
+    std::mutex sleep_lock;
+
+    /** Signaled when tasks are queued or the pool is stopping. */
+    std::condition_variable wake;
+
+    /** Whether the worker threads should exit. */
+    bool stop;
+
+
+    // WORKER POOL
+
+    /** Calls a function of the given type with a task index. */
+    template <typename F>
+    static void call_function(void *function, const size_t index) {
+        (*static_cast<F *>(function))(index);
+    }
+
+    /** Takes the newest task of the given worker's queue, or steals the oldest task of another. Pass SIZE_MAX to only steal. */
+    bool take(const size_t worker, task &next) {
+        const size_t count = workers;
+        if (worker < count) {
+            queue &own = queues[worker];
+            std::lock_guard<std::mutex> guard(own.lock);
+            if (!own.tasks.empty()) {
+                next = own.tasks.back();
+                own.tasks.pop_back();
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        const size_t start = worker < count ? worker + 1 : 0;
+        for (size_t i = 0; i < count; ++i) {
+            queue &other = queues[(start + i) % count];
+            std::lock_guard<std::mutex> guard(other.lock);
+            if (!other.tasks.empty()) {
+                next = other.tasks.front();
+                other.tasks.pop_front();
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /** Runs the given task and counts down its job. */
+    static void execute(const task &next) noexcept {
+        job &owner = *next.owner;
+        try {
+            owner.call(owner.function, next.index);
+        }
+        catch (...) {
+            if (!owner.failed.exchange(true)) {
+                owner.error = std::current_exception();
+            }
+        }
+        owner.done.count_down();
+    }
+
+    /** Runs tasks on a worker thread until the pool stops. */
+    void work(const size_t worker) {
+        task next = {};
+        while (true) {
+            if (take(worker, next)) {
+                execute(next);
+                continue;
+            }
+            std::unique_lock<std::mutex> guard(sleep_lock);
+            wake.wait(guard, [this]() {
+                return stop || queued.load() != 0;
+            });
+            if (stop && queued.load() == 0) {
+                return;
+            }
+        }
+    }
+
+    /** Stops and joins every worker thread. */
+    void join() noexcept {
+        {
+            std::lock_guard<std::mutex> guard(sleep_lock);
+            stop = true;
+        }
+        wake.notify_all();
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        threads.clear();
+    }
+
+public:
+
+    // CONSTRUCTORS AND DESTRUCTOR
+
+    /** Starts a thread pool with the given number of worker threads. 0 uses one per hardware thread, minus the caller. */
+    explicit worker_pool(size_t count = 0) : threads(), workers(count), queues(), queued(0), sleep_lock(), wake(), stop(false) {
+        if (count == 0) {
+            const size_t hardware = std::thread::hardware_concurrency();
+            workers = hardware > 1 ? hardware - 1 : 0;
+        }
+        queues.reset(new queue[workers == 0 ? 1 : workers]);
+        threads.reserve(workers);
+        try {
+            for (size_t i = 0; i < workers; ++i) {
+                threads.emplace_back(&worker_pool::work, this, i);
+            }
+        }
+        catch (...) {
+            join();
+            throw;
+        }
+    }
+
+    /** Delete copy constructor. */
+    worker_pool(const worker_pool &) = delete;
+
+    /** Destructor. Stops and joins every worker thread. No job may be running. */
+    ~worker_pool() {
+        join();
+    }
+
+
+    // OPERATORS
+
+    /** Delete copy assignment operator. */
+    worker_pool &operator=(const worker_pool &) = delete;
+
+
+    // WORKER POOL
+
+    /** Returns a pool with one worker per hardware thread, minus the caller, shared by the whole program. */
+    static worker_pool &shared() {
+        static worker_pool pool;
+        return pool;
+    }
+
+    /** Returns the number of threads that run tasks, including the calling thread. */
+    size_t size() const noexcept {
+        return workers + 1;
+    }
+
+    /**
+     * Calls the given function once for each index in [0, tasks) across the pool and the calling thread.<br/>
+     * Blocks until every task has finished, then rethrows the first exception a task threw. Any thread may run jobs at once.
+     */
+    template <typename F>
+    void run(const size_t tasks, F &&function) {
+        if (tasks == 0) {
+            return;
+        }
+        if (workers == 0 || tasks == 1) {
+            for (size_t i = 0; i < tasks; ++i) {
+                function(i);
+            }
+            return;
+        }
+        using function_type = std::remove_reference_t<F>;
+        job current(&call_function<function_type>, const_cast<void *>(static_cast<const void *>(&function)), tasks);
+        for (size_t worker = 0; worker < workers && worker < tasks; ++worker) {
+            queue &target = queues[worker];
+            std::lock_guard<std::mutex> guard(target.lock);
+            for (size_t i = worker; i < tasks; i += workers) {
+                target.tasks.push_back(task{&current, i});
+            }
+        }
+        {
+            std::lock_guard<std::mutex> guard(sleep_lock);
+            queued.fetch_add(tasks);
+        }
+        wake.notify_all();
+        task next = {};
+        while (!current.done.try_wait() && take(SIZE_MAX, next)) {
+            execute(next);
+        }
+        current.done.wait();
+        if (current.failed.load()) {
+            std::rethrow_exception(current.error);
+        }
+    }
+};
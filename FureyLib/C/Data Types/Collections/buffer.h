@@ -136,6 +136,105 @@ static inline bool name##_foreach_const(const name *self, bool(*action)(const ty
         }\
     }\
     return true;\
+}\
+\
+/** Iterates through the given buffer with the given function and context and returns whether the iteration successfully completed. */\
+static inline bool name##_foreach_ctx(name *self, bool(*action)(type *, void *), void *ctx) {\
+    if (self == NULL) {\
+        return false;\
+    }\
+    size_t count = self->count;\
+    for (buffer_id id = 0; id < size && count > 0; ++id) {\
+        if ((self->available[id / 8] & 1u << (id % 8)) != 0) {\
+            --count;\
+            if (!action(&self->buffer[id], ctx)) {\
+                return false;\
+            }\
+        }\
+    }\
+    return true;\
+}\
+\
+/** Iterates through the given buffer with the given const function and context and returns whether the iteration successfully completed. */\
+static inline bool name##_foreach_const_ctx(const name *self, bool(*action)(const type *, void *), void *ctx) {\
+    if (self == NULL) {\
+        return false;\
+    }\
+    size_t count = self->count;\
+    for (buffer_id id = 0; id < size && count > 0; ++id) {\
+        if ((self->available[id / 8] & 1u << (id % 8)) != 0) {\
+            --count;\
+            if (!action(&self->buffer[id], ctx)) {\
+                return false;\
+            }\
+        }\
+    }\
+    return true;\
+}\
+\
+/** Returns the ID after the contiguous run of occupied (or empty) spaces starting at the given ID. */\
+static inline buffer_id name##_run_end(const name *self, buffer_id id, bool occupied) {\
+    const uint8_t full = occupied ? 0xFF : 0x00;\
+    while (id < size) {\
+        if (id % 8 == 0 && id + 8 <= size && self->available[id / 8] == full) {\
+            id += 8;\
+        } else if (((self->available[id / 8] & 1u << (id % 8)) != 0) == occupied) {\
+            ++id;\
+        } else {\
+            break;\
+        }\
+    }\
+    return id;\
+}\
+\
+/**\
+ * Iterates through the given buffer by passing each contiguous span of occupied data to the given function with the given context.\
+ * Returns whether the iteration successfully completed.\
+ */\
+static inline bool name##_foreach_batch(name *self, bool(*action)(size_t n, type *span, void *ctx), void *ctx) {\
+    if (self == NULL) {\
+        return false;\
+    }\
+    size_t count = self->count;\
+    buffer_id id = 0;\
+    while (id < size && count > 0) {\
+        id = name##_run_end(self, id, false);\
+        if (id >= size) {\
+            break;\
+        }\
+        buffer_id end = name##_run_end(self, id, true);\
+        count -= end - id;\
+        if (!action(end - id, &self->buffer[id], ctx)) {\
+            return false;\
+        }\
+        id = end;\
+    }\
+    return true;\
+}\
+\
+/**\
+ * Iterates through the given buffer by passing each contiguous span of occupied data to the given const function with the given context.\
+ * Returns whether the iteration successfully completed.\
+ */\
+static inline bool name##_foreach_batch_const(const name *self, bool(*action)(size_t n, const type *span, void *ctx), void *ctx) {\
+    if (self == NULL) {\
+        return false;\
+    }\
+    size_t count = self->count;\
+    buffer_id id = 0;\
+    while (id < size && count > 0) {\
+        id = name##_run_end(self, id, false);\
+        if (id >= size) {\
+            break;\
+        }\
+        buffer_id end = name##_run_end(self, id, true);\
+        count -= end - id;\
+        if (!action(end - id, &self->buffer[id], ctx)) {\
+            return false;\
+        }\
+        id = end;\
+    }\
+    return true;\
 }
 
 /** Declares a fixed-sized buffer of the given type and size. */
@@ -9,6 +9,10 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /** The size of a memory block's header. */
 #define MEMBLOCK_SIZE \
 offsetof(memblock, data)
@@ -81,4 +85,8 @@ void *arena_realloc(arena *self, void *address, size_t size);
 /** Frees memory from the given memory arena. False on failure. */
 bool arena_free(arena *self, void *address);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif // ARENA_H
@@ -0,0 +1,137 @@
+// .c
+// Fork-Join Thread Pool Structure
+// by Kyle Furey
+
+#include "thread_pool.h"
+#include <unistd.h>
+
+/** Claims and runs tasks of the current job until none remain. Must be called with the lock held, and returns with it held. */
+static void thread_pool_work(thread_pool *self) {
+	while (self->next < self->tasks) {
+		size_t index = self->next++;
+		thread_pool_task task = self->task;
+		void *ctx = self->ctx;
+		pthread_mutex_unlock(&self->lock);
+		task(index, ctx);
+		pthread_mutex_lock(&self->lock);
+		if (++self->finished == self->tasks) {
+			pthread_cond_signal(&self->done);
+		}
+	}
+}
+
+/** The entry point of each worker thread. */
+static void *thread_pool_main(void *arg) {
+	thread_pool *self = (thread_pool *)arg;
+	pthread_mutex_lock(&self->lock);
+	size_t generation = self->generation;
+	while (true) {
+		while (!self->stop && self->generation == generation) {
+			pthread_cond_wait(&self->start, &self->lock);
+		}
+		if (self->stop) {
+			break;
+		}
+		generation = self->generation;
+		thread_pool_work(self);
+	}
+	pthread_mutex_unlock(&self->lock);
+	return NULL;
+}
+
+/** Starts a thread pool with the given number of worker threads (0 uses one per online processor, minus the caller). False on failure. */
+bool thread_pool_init(thread_pool *self, size_t threads) {
+	if (self == NULL) {
+		return false;
+	}
+	if (threads == 0) {
+		long online = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = online > 1 ? (size_t)online - 1 : 0;
+	}
+	if (threads > THREAD_POOL_MAX_THREADS) {
+		threads = THREAD_POOL_MAX_THREADS;
+	}
+	self->count = 0;
+	self->task = NULL;
+	self->ctx = NULL;
+	self->tasks = 0;
+	self->next = 0;
+	self->finished = 0;
+	self->generation = 0;
+	self->stop = false;
+	if (pthread_mutex_init(&self->lock, NULL) != 0) {
+		return false;
+	}
+	if (pthread_cond_init(&self->start, NULL) != 0) {
+		pthread_mutex_destroy(&self->lock);
+		return false;
+	}
+	if (pthread_cond_init(&self->done, NULL) != 0) {
+		pthread_cond_destroy(&self->start);
+		pthread_mutex_destroy(&self->lock);
+		return false;
+	}
+	for (size_t i = 0; i < threads; ++i) {
+		if (pthread_create(&self->threads[i], NULL, thread_pool_main, self) != 0) {
+			thread_pool_destroy(self);
+			return false;
+		}
+		++self->count;
+	}
+	return true;
+}
+
+/** Stops and joins every worker thread of the given thread pool. */
+void thread_pool_destroy(thread_pool *self) {
+	if (self == NULL) {
+		return;
+	}
+	pthread_mutex_lock(&self->lock);
+	self->stop = true;
+	pthread_cond_broadcast(&self->start);
+	pthread_mutex_unlock(&self->lock);
+	for (size_t i = 0; i < self->count; ++i) {
+		pthread_join(self->threads[i], NULL);
+	}
+	self->count = 0;
+	pthread_cond_destroy(&self->done);
+	pthread_cond_destroy(&self->start);
+	pthread_mutex_destroy(&self->lock);
+}
+
+/** Returns the number of threads that run tasks in the given thread pool, including the calling thread. */
+size_t thread_pool_size(const thread_pool *self) {
+	return self != NULL ? self->count + 1 : 1;
+}
+
+/**
+ * Calls <task> once for each index in [0, <tasks>) across the given thread pool and the calling thread.
+ * Blocks until every task has finished. Runs every task on the calling thread if <self> is NULL.
+ * Only one thread may run jobs on a pool at a time.
+ */
+void thread_pool_run(thread_pool *self, size_t tasks, thread_pool_task task, void *ctx) {
+	if (task == NULL || tasks == 0) {
+		return;
+	}
+	if (self == NULL || self->count == 0 || tasks == 1) {
+		for (size_t i = 0; i < tasks; ++i) {
+			task(i, ctx);
+		}
+		return;
+	}
+	pthread_mutex_lock(&self->lock);
+	self->task = task;
+	self->ctx = ctx;
+	self->tasks = tasks;
+	self->next = 0;
+	self->finished = 0;
+	++self->generation;
+	pthread_cond_broadcast(&self->start);
+	thread_pool_work(self);
+	while (self->finished < self->tasks) {
+		pthread_cond_wait(&self->done, &self->lock);
+	}
+	self->task = NULL;
+	self->ctx = NULL;
+	pthread_mutex_unlock(&self->lock);
+}
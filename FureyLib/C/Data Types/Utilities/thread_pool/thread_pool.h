@@ -0,0 +1,74 @@
+// .h
+// Fork-Join Thread Pool Structure
+// by Kyle Furey
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+/** The maximum number of worker threads a thread pool can own. */
+#define THREAD_POOL_MAX_THREADS \
+64
+
+/** A function run by a thread pool for each task index of a job. */
+typedef void (*thread_pool_task)(size_t index, void *ctx);
+
+/** A reusable set of worker threads that run indexed tasks in parallel with the calling thread. */
+typedef struct {
+	/** The worker threads of this pool. */
+	pthread_t threads[THREAD_POOL_MAX_THREADS];
+
+	/** The number of worker threads of this pool. */
+	size_t count;
+
+	/** Guards every field below. */
+	pthread_mutex_t lock;
+
+	/** Signaled when a new job is started or the pool is stopping. */
+	pthread_cond_t start;
+
+	/** Signaled when the last task of the current job finishes. */
+	pthread_cond_t done;
+
+	/** The function of the current job. */
+	thread_pool_task task;
+
+	/** The context of the current job. */
+	void *ctx;
+
+	/** The number of tasks in the current job. */
+	size_t tasks;
+
+	/** The index of the next task of the current job to be claimed. */
+	size_t next;
+
+	/** The number of tasks of the current job that have finished. */
+	size_t finished;
+
+	/** Incremented each time a job is started. */
+	size_t generation;
+
+	/** Whether the worker threads should exit. */
+	bool stop;
+} thread_pool;
+
+/** Starts a thread pool with the given number of worker threads (0 uses one per online processor, minus the caller). False on failure. */
+bool thread_pool_init(thread_pool *self, size_t threads);
+
+/** Stops and joins every worker thread of the given thread pool. */
+void thread_pool_destroy(thread_pool *self);
+
+/** Returns the number of threads that run tasks in the given thread pool, including the calling thread. */
+size_t thread_pool_size(const thread_pool *self);
+
+/**
+ * Calls <task> once for each index in [0, <tasks>) across the given thread pool and the calling thread.
+ * Blocks until every task has finished. Runs every task on the calling thread if <self> is NULL.
+ * Only one thread may run jobs on a pool at a time.
+ */
+void thread_pool_run(thread_pool *self, size_t tasks, thread_pool_task task, void *ctx);
+
+#endif // THREAD_POOL_H
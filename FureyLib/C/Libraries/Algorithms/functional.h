@@ -11,7 +11,7 @@
 
 /**
  * Declares named higher-order functions for the given array type:
- * map(), filter(), reduce(), and foreach().
+ * map(), filter(), reduce(), and foreach(), with _ctx() and _batch() variants.
  */
 #define DECLARE_FUNCTIONAL_NAMED(T, typename)\
 \
@@ -86,6 +86,114 @@ static inline bool foreach_##typename(size_t n, const T *array, bool(*action)(T
     return true;\
 }\
 \
+/**\
+ * Iterates <array> and fills <out> with each element returned by <transform> with <ctx>.\
+ * Returns <out>. <out> cannot be NULL.\
+ */\
+static inline T *map_##typename##_ctx(size_t n, const T *array, T(*transform)(T elem, void *ctx), void *ctx, T *out) {\
+    assert(array != NULL);\
+    assert(transform != NULL);\
+    assert(out != NULL);\
+    for (size_t i = 0; i < n; ++i) {\
+        out[i] = transform(array[i], ctx);\
+    }\
+    return out;\
+}\
+\
+/**\
+ * Iterates <array> and fills <out> with each elements that passes <predicate> with <ctx>.\
+ * Returns the new size of <out>. <out> can be NULL.\
+ */\
+static inline size_t filter_##typename##_ctx(size_t n, const T *array, bool(*predicate)(T elem, void *ctx), void *ctx, T *out) {\
+    assert(array != NULL);\
+    assert(predicate != NULL);\
+    size_t count = 0;\
+    if (out != NULL) {\
+        for (size_t i = 0; i < n; ++i) {\
+            if (predicate(array[i], ctx)) {\
+                out[count++] = array[i];\
+            }\
+        }\
+        return count;\
+    }\
+    for (size_t i = 0; i < n; ++i) {\
+        if (predicate(array[i], ctx)) {\
+            ++count;\
+        }\
+    }\
+    return count;\
+}\
+\
+/**\
+ * Iterates <array>, setting <start> to the result of <accumulator> with <start>, the current element, and <ctx>.\
+ * Returns the final value created by <accumulator>.\
+ */\
+static inline T reduce_##typename##_ctx(size_t n, const T *array, T(*accumulator)(T acc, T elem, void *ctx), void *ctx, T start) {\
+    assert(array != NULL);\
+    assert(accumulator != NULL);\
+    for (size_t i = 0; i < n; ++i) {\
+        start = accumulator(start, array[i], ctx);\
+    }\
+    return start;\
+}\
+\
+/**\
+ * Iterates <array> and calls <action> on each element with <ctx>.\
+ * <action> returns whether the loop should continue.\
+ * <out> is set to the element that stopped the loop.\
+ * Returns whether the loop successfully completed. <out> can be NULL. \
+ */\
+static inline bool foreach_##typename##_ctx(size_t n, const T *array, bool(*action)(T elem, void *ctx), void *ctx, T *out) {\
+    assert(array != NULL);\
+    assert(action != NULL);\
+    for (size_t i = 0; i < n; ++i) {\
+        if (!action(array[i], ctx)) {\
+            if (out != NULL) {\
+                *out = array[i];\
+            }\
+            return false;\
+        }\
+    }\
+    return true;\
+}\
+\
+/**\
+ * Splits <array> into spans of up to <batch> elements and calls <transform> on each span with <ctx>.\
+ * <transform> fills the matching span of <out>. A <batch> of 0 passes the whole array at once.\
+ * Returns <out>. <out> cannot be NULL.\
+ */\
+static inline T *map_##typename##_batch(size_t n, const T *array, void(*transform)(size_t n, const T *span, T *out, void *ctx), size_t batch, void *ctx, T *out) {\
+    assert(array != NULL);\
+    assert(transform != NULL);\
+    assert(out != NULL);\
+    if (batch == 0) {\
+        batch = n;\
+    }\
+    for (size_t i = 0; i < n; i += batch) {\
+        transform(n - i < batch ? n - i : batch, array + i, out + i, ctx);\
+    }\
+    return out;\
+}\
+\
+/**\
+ * Splits <array> into spans of up to <batch> elements and calls <action> on each span with <ctx>.\
+ * <action> returns whether the loop should continue. A <batch> of 0 passes the whole array at once.\
+ * Returns whether the loop successfully completed.\
+ */\
+static inline bool foreach_##typename##_batch(size_t n, const T *array, bool(*action)(size_t n, const T *span, void *ctx), size_t batch, void *ctx) {\
+    assert(array != NULL);\
+    assert(action != NULL);\
+    if (batch == 0) {\
+        batch = n;\
+    }\
+    for (size_t i = 0; i < n; i += batch) {\
+        if (!action(n - i < batch ? n - i : batch, array + i, ctx)) {\
+            return false;\
+        }\
+    }\
+    return true;\
+}\
+\
 /**\
  * Reverses <array> into <out>.\
  * Returns <out>. <out> cannot be NULL.\
@@ -109,9 +217,60 @@ static inline T *reverse_##typename(size_t n, const T *array, T *out) {\
     return out;\
 }
 
+/**
+ * Declares a named map() for the given array type that applies <transform> to each element.
+ * <transform> is an inlinable expression macro or static inline function, so the loop can be vectorized.
+ * The declared function fills <out> and returns <out>. <out> cannot be NULL.
+ */
+#define DECLARE_MAP_INLINE_NAMED(T, name, transform)\
+static inline T *name(size_t n, const T *array, T *out) {\
+    assert(array != NULL);\
+    assert(out != NULL);\
+    for (size_t i = 0; i < n; ++i) {\
+        out[i] = transform(array[i]);\
+    }\
+    return out;\
+}
+
+/**
+ * Declares a named filter() for the given array type that keeps each element passing <predicate>.
+ * <predicate> is an inlinable expression macro or static inline function, so the loop can be vectorized.
+ * The declared function fills <out> and returns its new size. <out> must hold <n> elements and can be NULL.
+ */
+#define DECLARE_FILTER_INLINE_NAMED(T, name, predicate)\
+static inline size_t name(size_t n, const T *array, T *out) {\
+    assert(array != NULL);\
+    size_t count = 0;\
+    if (out != NULL) {\
+        for (size_t i = 0; i < n; ++i) {\
+            out[count] = array[i];\
+            count += (predicate(array[i])) ? 1 : 0;\
+        }\
+        return count;\
+    }\
+    for (size_t i = 0; i < n; ++i) {\
+        count += (predicate(array[i])) ? 1 : 0;\
+    }\
+    return count;\
+}
+
+/**
+ * Declares a named reduce() for the given array type that folds each element into <start> with <accumulator>.
+ * <accumulator> is an inlinable expression macro or static inline function, so the loop can be vectorized.
+ * The declared function returns the final value created by <accumulator>.
+ */
+#define DECLARE_REDUCE_INLINE_NAMED(T, name, accumulator)\
+static inline T name(size_t n, const T *array, T start) {\
+    assert(array != NULL);\
+    for (size_t i = 0; i < n; ++i) {\
+        start = accumulator(start, array[i]);\
+    }\
+    return start;\
+}
+
 /**
  * Declares higher-order functions for the given array type:
- * map(), filter(), reduce(), and foreach().
+ * map(), filter(), reduce(), and foreach(), with _ctx() and _batch() variants.
  */
 #define DECLARE_FUNCTIONAL(T) DECLARE_FUNCTIONAL_NAMED(T, T)
 
@@ -0,0 +1,676 @@
+// .h
+// SIMD Higher-Order Function Kernels
+// by Kyle Furey
+
+#ifndef FUNCTIONAL_SIMD_H
+#define FUNCTIONAL_SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <assert.h>
+
+/** No vector instructions are used. */
+#define FUNCTIONAL_SIMD_NONE 0
+
+/** SSE2 instructions are used for sums and floating point minimums and maximums. */
+#define FUNCTIONAL_SIMD_SSE2 1
+
+/** SSSE3 instructions are also used for stream compaction with pshufb tables. */
+#define FUNCTIONAL_SIMD_SSSE3 2
+
+/** SSE4.1 instructions are also used for integer minimums and maximums. */
+#define FUNCTIONAL_SIMD_SSE41 3
+
+/** AVX2 instructions are used for 256-bit kernels. */
+#define FUNCTIONAL_SIMD_AVX2 4
+
+/** AVX-512 instructions are also used for stream compaction with vpcompress. */
+#define FUNCTIONAL_SIMD_AVX512 5
+
+#ifndef FUNCTIONAL_SIMD
+// The highest instruction set used by these kernels, detected from the compiler's target flags.
+#if defined(__AVX512F__)
+#define FUNCTIONAL_SIMD FUNCTIONAL_SIMD_AVX512
+#elif defined(__AVX2__)
+#define FUNCTIONAL_SIMD FUNCTIONAL_SIMD_AVX2
+#elif defined(__SSE4_1__)
+#define FUNCTIONAL_SIMD FUNCTIONAL_SIMD_SSE41
+#elif defined(__SSSE3__)
+#define FUNCTIONAL_SIMD FUNCTIONAL_SIMD_SSSE3
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FUNCTIONAL_SIMD FUNCTIONAL_SIMD_SSE2
+#else
+#define FUNCTIONAL_SIMD FUNCTIONAL_SIMD_NONE
+#endif
+#endif
+
+#if FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_AVX2
+#include <immintrin.h>
+#elif FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_SSE41
+#include <smmintrin.h>
+#elif FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_SSSE3
+#include <tmmintrin.h>
+#elif FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+/*
+ * Hand-vectorized sum(), min(), max(), and filter() kernels for int32_t, float, and double arrays.
+ * The instruction set is chosen at compile time. Define FUNCTIONAL_SIMD as FUNCTIONAL_SIMD_NONE to force scalar loops.
+ * Floating point sums are accumulated per lane, so they may round differently than a sequential reduce().
+ * Floating point minimums and maximums do not propagate NaN.
+ */
+
+
+// HELPERS
+
+/** Returns the number of set bits in the lowest 4 bits of the given mask. */
+static inline size_t functional_popcount4(unsigned mask) {
+    static const uint8_t counts[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+    return counts[mask & 0xF];
+}
+
+#if FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_SSSE3
+/** pshufb controls that pack each selected lane of a 4 x 32-bit vector to the front, indexed by lane mask. */
+static const uint8_t functional_compact_table_epi32[16][16] = {
+    {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0x00, 0x01, 0x02, 0x03, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0x04, 0x05, 0x06, 0x07, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0x08, 0x09, 0x0A, 0x0B, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0x00, 0x01, 0x02, 0x03, 0x08, 0x09, 0x0A, 0x0B, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x80, 0x80, 0x80, 0x80},
+    {0x0C, 0x0D, 0x0E, 0x0F, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0x00, 0x01, 0x02, 0x03, 0x0C, 0x0D, 0x0E, 0x0F, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0x04, 0x05, 0x06, 0x07, 0x0C, 0x0D, 0x0E, 0x0F, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x0C, 0x0D, 0x0E, 0x0F, 0x80, 0x80, 0x80, 0x80},
+    {0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0x00, 0x01, 0x02, 0x03, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x80, 0x80, 0x80, 0x80},
+    {0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x80, 0x80, 0x80, 0x80},
+    {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F}
+};
+
+/** pshufb controls that pack each selected lane of a 2 x 64-bit vector to the front, indexed by lane mask. */
+static const uint8_t functional_compact_table_epi64[4][16] = {
+    {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F}
+};
+
+/** Stores each 32-bit lane of <v> selected by <mask> contiguously into <out> and returns the number stored. */
+static inline size_t functional_compact_epi32(__m128i v, int mask, void *out) {
+    const __m128i control = _mm_loadu_si128((const __m128i *)functional_compact_table_epi32[mask]);
+    _mm_storeu_si128((__m128i *)out, _mm_shuffle_epi8(v, control));
+    return functional_popcount4((unsigned)mask);
+}
+
+/** Stores each 64-bit lane of <v> selected by <mask> contiguously into <out> and returns the number stored. */
+static inline size_t functional_compact_epi64(__m128i v, int mask, void *out) {
+    const __m128i control = _mm_loadu_si128((const __m128i *)functional_compact_table_epi64[mask]);
+    _mm_storeu_si128((__m128i *)out, _mm_shuffle_epi8(v, control));
+    return functional_popcount4((unsigned)mask);
+}
+#endif
+
+#if FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_SSE2
+/** Returns the sum of each lane of <v>. */
+static inline int32_t functional_hsum_epi32(__m128i v) {
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, 0x4E));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, 0xB1));
+    return _mm_cvtsi128_si32(v);
+}
+
+/** Returns the sum of each lane of <v>. */
+static inline float functional_hsum_ps(__m128 v) {
+    v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 0x55));
+    return _mm_cvtss_f32(v);
+}
+
+/** Returns the minimum of each lane of <v>. */
+static inline float functional_hmin_ps(__m128 v) {
+    v = _mm_min_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_min_ss(v, _mm_shuffle_ps(v, v, 0x55));
+    return _mm_cvtss_f32(v);
+}
+
+/** Returns the maximum of each lane of <v>. */
+static inline float functional_hmax_ps(__m128 v) {
+    v = _mm_max_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_max_ss(v, _mm_shuffle_ps(v, v, 0x55));
+    return _mm_cvtss_f32(v);
+}
+
+/** Returns the sum of each lane of <v>. */
+static inline double functional_hsum_pd(__m128d v) {
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+/** Returns the minimum of each lane of <v>. */
+static inline double functional_hmin_pd(__m128d v) {
+    return _mm_cvtsd_f64(_mm_min_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+/** Returns the maximum of each lane of <v>. */
+static inline double functional_hmax_pd(__m128d v) {
+    return _mm_cvtsd_f64(_mm_max_sd(v, _mm_unpackhi_pd(v, v)));
+}
+#endif
+
+#if FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_SSE41
+/** Returns the minimum of each lane of <v>. */
+static inline int32_t functional_hmin_epi32(__m128i v) {
+    v = _mm_min_epi32(v, _mm_shuffle_epi32(v, 0x4E));
+    v = _mm_min_epi32(v, _mm_shuffle_epi32(v, 0xB1));
+    return _mm_cvtsi128_si32(v);
+}
+
+/** Returns the maximum of each lane of <v>. */
+static inline int32_t functional_hmax_epi32(__m128i v) {
+    v = _mm_max_epi32(v, _mm_shuffle_epi32(v, 0x4E));
+    v = _mm_max_epi32(v, _mm_shuffle_epi32(v, 0xB1));
+    return _mm_cvtsi128_si32(v);
+}
+#endif
+
+
+// INT32
+
+/** Returns the sum of each element of <array>, wrapping on overflow. */
+static inline int32_t sum_int32(size_t n, const int32_t *array) {
+    assert(array != NULL || n == 0);
+    size_t i = 0;
+    uint32_t result = 0;
+#if FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_AVX2
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_add_epi32(acc0, _mm256_loadu_si256((const __m256i *)(array + i)));
+        acc1 = _mm256_add_epi32(acc1, _mm256_loadu_si256((const __m256i *)(array + i + 8)));
+    }
+    acc0 = _mm256_add_epi32(acc0, acc1);
+    result = (uint32_t)functional_hsum_epi32(_mm_add_epi32(_mm256_castsi256_si128(acc0), _mm256_extracti128_si256(acc0, 1)));
+#elif FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_SSE2
+    __m128i acc0 = _mm_setzero_si128();
+    __m128i acc1 = _mm_setzero_si128();
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_epi32(acc0, _mm_loadu_si128((const __m128i *)(array + i)));
+        acc1 = _mm_add_epi32(acc1, _mm_loadu_si128((const __m128i *)(array + i + 4)));
+    }
+    result = (uint32_t)functional_hsum_epi32(_mm_add_epi32(acc0, acc1));
+#endif
+    for (; i < n; ++i) {
+        result += (uint32_t)array[i];
+    }
+    return (int32_t)result;
+}
+
+/** Returns the smallest element of <array>. <n> cannot be 0. */
+static inline int32_t min_int32(size_t n, const int32_t *array) {
+    assert(array != NULL);
+    assert(n > 0);
+    size_t i = 0;
+    int32_t result = array[0];
+#if FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_AVX2
+    __m256i acc = _mm256_set1_epi32(result);
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm256_min_epi32(acc, _mm256_loadu_si256((const __m256i *)(array + i)));
+    }
+    result = functional_hmin_epi32(_mm_min_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1)));
+#elif FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_SSE41
+    __m128i acc = _mm_set1_epi32(result);
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm_min_epi32(acc, _mm_loadu_si128((const __m128i *)(array + i)));
+    }
+    result = functional_hmin_epi32(acc);
+#endif
+    for (; i < n; ++i) {
+        result = array[i] < result ? array[i] : result;
+    }
+    return result;
+}
+
+/** Returns the largest element of <array>. <n> cannot be 0. */
+static inline int32_t max_int32(size_t n, const int32_t *array) {
+    assert(array != NULL);
+    assert(n > 0);
+    size_t i = 0;
+    int32_t result = array[0];
+#if FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_AVX2
+    __m256i acc = _mm256_set1_epi32(result);
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm256_max_epi32(acc, _mm256_loadu_si256((const __m256i *)(array + i)));
+    }
+    result = functional_hmax_epi32(_mm_max_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1)));
+#elif FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_SSE41
+    __m128i acc = _mm_set1_epi32(result);
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm_max_epi32(acc, _mm_loadu_si128((const __m128i *)(array + i)));
+    }
+    result = functional_hmax_epi32(acc);
+#endif
+    for (; i < n; ++i) {
+        result = array[i] > result ? array[i] : result;
+    }
+    return result;
+}
+
+/**
+ * Fills <out> with each element of <array> that is greater than <pivot>, preserving order.
+ * Returns the new size of <out>. <out> must hold <n> elements and can be NULL.
+ */
+static inline size_t filter_greater_int32(size_t n, const int32_t *array, int32_t pivot, int32_t *out) {
+    assert(array != NULL || n == 0);
+    size_t i = 0;
+    size_t count = 0;
+    if (out == NULL) {
+        for (; i < n; ++i) {
+            count += array[i] > pivot ? 1 : 0;
+        }
+        return count;
+    }
+#if FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_AVX512
+    const __m512i p = _mm512_set1_epi32(pivot);
+    for (; i + 16 <= n; i += 16) {
+        const __m512i v = _mm512_loadu_si512((const void *)(array + i));
+        const __mmask16 mask = _mm512_cmpgt_epi32_mask(v, p);
+        _mm512_mask_compressstoreu_epi32(out + count, mask, v);
+        count += functional_popcount4(mask) + functional_popcount4(mask >> 4) +
+                 functional_popcount4(mask >> 8) + functional_popcount4(mask >> 12);
+    }
+#elif FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_AVX2
+    const __m256i p = _mm256_set1_epi32(pivot);
+    for (; i + 8 <= n; i += 8) {
+        const __m256i v = _mm256_loadu_si256((const __m256i *)(array + i));
+        const int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, p)));
+        count += functional_compact_epi32(_mm256_castsi256_si128(v), mask & 0xF, out + count);
+        count += functional_compact_epi32(_mm256_extracti128_si256(v, 1), mask >> 4, out + count);
+    }
+#elif FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_SSSE3
+    const __m128i p = _mm_set1_epi32(pivot);
+    for (; i + 4 <= n; i += 4) {
+        const __m128i v = _mm_loadu_si128((const __m128i *)(array + i));
+        count += functional_compact_epi32(v, _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(v, p))), out + count);
+    }
+#endif
+    for (; i < n; ++i) {
+        out[count] = array[i];
+        count += array[i] > pivot ? 1 : 0;
+    }
+    return count;
+}
+
+/**
+ * Fills <out> with each element of <array> that is less than <pivot>, preserving order.
+ * Returns the new size of <out>. <out> must hold <n> elements and can be NULL.
+ */
+static inline size_t filter_less_int32(size_t n, const int32_t *array, int32_t pivot, int32_t *out) {
+    assert(array != NULL || n == 0);
+    size_t i = 0;
+    size_t count = 0;
+    if (out == NULL) {
+        for (; i < n; ++i) {
+            count += array[i] < pivot ? 1 : 0;
+        }
+        return count;
+    }
+#if FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_AVX512
+    const __m512i p = _mm512_set1_epi32(pivot);
+    for (; i + 16 <= n; i += 16) {
+        const __m512i v = _mm512_loadu_si512((const void *)(array + i));
+        const __mmask16 mask = _mm512_cmplt_epi32_mask(v, p);
+        _mm512_mask_compressstoreu_epi32(out + count, mask, v);
+        count += functional_popcount4(mask) + functional_popcount4(mask >> 4) +
+                 functional_popcount4(mask >> 8) + functional_popcount4(mask >> 12);
+    }
+#elif FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_AVX2
+    const __m256i p = _mm256_set1_epi32(pivot);
+    for (; i + 8 <= n; i += 8) {
+        const __m256i v = _mm256_loadu_si256((const __m256i *)(array + i));
+        const int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(p, v)));
+        count += functional_compact_epi32(_mm256_castsi256_si128(v), mask & 0xF, out + count);
+        count += functional_compact_epi32(_mm256_extracti128_si256(v, 1), mask >> 4, out + count);
+    }
+#elif FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_SSSE3
+    const __m128i p = _mm_set1_epi32(pivot);
+    for (; i + 4 <= n; i += 4) {
+        const __m128i v = _mm_loadu_si128((const __m128i *)(array + i));
+        count += functional_compact_epi32(v, _mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(v, p))), out + count);
+    }
+#endif
+    for (; i < n; ++i) {
+        out[count] = array[i];
+        count += array[i] < pivot ? 1 : 0;
+    }
+    return count;
+}
+
+
+// FLOAT
+
+/** Returns the sum of each element of <array>. */
+static inline float sum_float(size_t n, const float *array) {
+    assert(array != NULL || n == 0);
+    size_t i = 0;
+    float result = 0;
+#if FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_AVX2
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(array + i));
+        acc1 = _mm256_add_ps(acc1, _mm256_loadu_ps(array + i + 8));
+    }
+    acc0 = _mm256_add_ps(acc0, acc1);
+    result = functional_hsum_ps(_mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1)));
+#elif FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_SSE2
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_loadu_ps(array + i));
+        acc1 = _mm_add_ps(acc1, _mm_loadu_ps(array + i + 4));
+    }
+    result = functional_hsum_ps(_mm_add_ps(acc0, acc1));
+#endif
+    for (; i < n; ++i) {
+        result += array[i];
+    }
+    return result;
+}
+
+/** Returns the smallest element of <array>. <n> cannot be 0. */
+static inline float min_float(size_t n, const float *array) {
+    assert(array != NULL);
+    assert(n > 0);
+    size_t i = 0;
+    float result = array[0];
+#if FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_AVX2
+    __m256 acc = _mm256_set1_ps(result);
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm256_min_ps(acc, _mm256_loadu_ps(array + i));
+    }
+    result = functional_hmin_ps(_mm_min_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1)));
+#elif FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_SSE2
+    __m128 acc = _mm_set1_ps(result);
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm_min_ps(acc, _mm_loadu_ps(array + i));
+    }
+    result = functional_hmin_ps(acc);
+#endif
+    for (; i < n; ++i) {
+        result = array[i] < result ? array[i] : result;
+    }
+    return result;
+}
+
+/** Returns the largest element of <array>. <n> cannot be 0. */
+static inline float max_float(size_t n, const float *array) {
+    assert(array != NULL);
+    assert(n > 0);
+    size_t i = 0;
+    float result = array[0];
+#if FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_AVX2
+    __m256 acc = _mm256_set1_ps(result);
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm256_max_ps(acc, _mm256_loadu_ps(array + i));
+    }
+    result = functional_hmax_ps(_mm_max_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1)));
+#elif FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_SSE2
+    __m128 acc = _mm_set1_ps(result);
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm_max_ps(acc, _mm_loadu_ps(array + i));
+    }
+    result = functional_hmax_ps(acc);
+#endif
+    for (; i < n; ++i) {
+        result = array[i] > result ? array[i] : result;
+    }
+    return result;
+}
+
+/**
+ * Fills <out> with each element of <array> that is greater than <pivot>, preserving order.
+ * Returns the new size of <out>. <out> must hold <n> elements and can be NULL.
+ */
+static inline size_t filter_greater_float(size_t n, const float *array, float pivot, float *out) {
+    assert(array != NULL || n == 0);
+    size_t i = 0;
+    size_t count = 0;
+    if (out == NULL) {
+        for (; i < n; ++i) {
+            count += array[i] > pivot ? 1 : 0;
+        }
+        return count;
+    }
+#if FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_AVX512
+    const __m512 p = _mm512_set1_ps(pivot);
+    for (; i + 16 <= n; i += 16) {
+        const __m512 v = _mm512_loadu_ps(array + i);
+        const __mmask16 mask = _mm512_cmp_ps_mask(v, p, _CMP_GT_OQ);
+        _mm512_mask_compressstoreu_ps(out + count, mask, v);
+        count += functional_popcount4(mask) + functional_popcount4(mask >> 4) +
+                 functional_popcount4(mask >> 8) + functional_popcount4(mask >> 12);
+    }
+#elif FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_AVX2
+    const __m256 p = _mm256_set1_ps(pivot);
+    for (; i + 8 <= n; i += 8) {
+        const __m256 v = _mm256_loadu_ps(array + i);
+        const int mask = _mm256_movemask_ps(_mm256_cmp_ps(v, p, _CMP_GT_OQ));
+        count += functional_compact_epi32(_mm_castps_si128(_mm256_castps256_ps128(v)), mask & 0xF, out + count);
+        count += functional_compact_epi32(_mm_castps_si128(_mm256_extractf128_ps(v, 1)), mask >> 4, out + count);
+    }
+#elif FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_SSSE3
+    const __m128 p = _mm_set1_ps(pivot);
+    for (; i + 4 <= n; i += 4) {
+        const __m128 v = _mm_loadu_ps(array + i);
+        count += functional_compact_epi32(_mm_castps_si128(v), _mm_movemask_ps(_mm_cmpgt_ps(v, p)), out + count);
+    }
+#endif
+    for (; i < n; ++i) {
+        out[count] = array[i];
+        count += array[i] > pivot ? 1 : 0;
+    }
+    return count;
+}
+
+/**
+ * Fills <out> with each element of <array> that is less than <pivot>, preserving order.
+ * Returns the new size of <out>. <out> must hold <n> elements and can be NULL.
+ */
+static inline size_t filter_less_float(size_t n, const float *array, float pivot, float *out) {
+    assert(array != NULL || n == 0);
+    size_t i = 0;
+    size_t count = 0;
+    if (out == NULL) {
+        for (; i < n; ++i) {
+            count += array[i] < pivot ? 1 : 0;
+        }
+        return count;
+    }
+#if FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_AVX512
+    const __m512 p = _mm512_set1_ps(pivot);
+    for (; i + 16 <= n; i += 16) {
+        const __m512 v = _mm512_loadu_ps(array + i);
+        const __mmask16 mask = _mm512_cmp_ps_mask(v, p, _CMP_LT_OQ);
+        _mm512_mask_compressstoreu_ps(out + count, mask, v);
+        count += functional_popcount4(mask) + functional_popcount4(mask >> 4) +
+                 functional_popcount4(mask >> 8) + functional_popcount4(mask >> 12);
+    }
+#elif FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_AVX2
+    const __m256 p = _mm256_set1_ps(pivot);
+    for (; i + 8 <= n; i += 8) {
+        const __m256 v = _mm256_loadu_ps(array + i);
+        const int mask = _mm256_movemask_ps(_mm256_cmp_ps(v, p, _CMP_LT_OQ));
+        count += functional_compact_epi32(_mm_castps_si128(_mm256_castps256_ps128(v)), mask & 0xF, out + count);
+        count += functional_compact_epi32(_mm_castps_si128(_mm256_extractf128_ps(v, 1)), mask >> 4, out + count);
+    }
+#elif FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_SSSE3
+    const __m128 p = _mm_set1_ps(pivot);
+    for (; i + 4 <= n; i += 4) {
+        const __m128 v = _mm_loadu_ps(array + i);
+        count += functional_compact_epi32(_mm_castps_si128(v), _mm_movemask_ps(_mm_cmplt_ps(v, p)), out + count);
+    }
+#endif
+    for (; i < n; ++i) {
+        out[count] = array[i];
+        count += array[i] < pivot ? 1 : 0;
+    }
+    return count;
+}
+
+
+// DOUBLE
+
+/** Returns the sum of each element of <array>. */
+static inline double sum_double(size_t n, const double *array) {
+    assert(array != NULL || n == 0);
+    size_t i = 0;
+    double result = 0;
+#if FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_AVX2
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(array + i));
+        acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(array + i + 4));
+    }
+    acc0 = _mm256_add_pd(acc0, acc1);
+    result = functional_hsum_pd(_mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1)));
+#elif FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_SSE2
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_loadu_pd(array + i));
+        acc1 = _mm_add_pd(acc1, _mm_loadu_pd(array + i + 2));
+    }
+    result = functional_hsum_pd(_mm_add_pd(acc0, acc1));
+#endif
+    for (; i < n; ++i) {
+        result += array[i];
+    }
+    return result;
+}
+
+/** Returns the smallest element of <array>. <n> cannot be 0. */
+static inline double min_double(size_t n, const double *array) {
+    assert(array != NULL);
+    assert(n > 0);
+    size_t i = 0;
+    double result = array[0];
+#if FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_AVX2
+    __m256d acc = _mm256_set1_pd(result);
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm256_min_pd(acc, _mm256_loadu_pd(array + i));
+    }
+    result = functional_hmin_pd(_mm_min_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1)));
+#elif FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_SSE2
+    __m128d acc = _mm_set1_pd(result);
+    for (; i + 2 <= n; i += 2) {
+        acc = _mm_min_pd(acc, _mm_loadu_pd(array + i));
+    }
+    result = functional_hmin_pd(acc);
+#endif
+    for (; i < n; ++i) {
+        result = array[i] < result ? array[i] : result;
+    }
+    return result;
+}
+
+/** Returns the largest element of <array>. <n> cannot be 0. */
+static inline double max_double(size_t n, const double *array) {
+    assert(array != NULL);
+    assert(n > 0);
+    size_t i = 0;
+    double result = array[0];
+#if FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_AVX2
+    __m256d acc = _mm256_set1_pd(result);
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm256_max_pd(acc, _mm256_loadu_pd(array + i));
+    }
+    result = functional_hmax_pd(_mm_max_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1)));
+#elif FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_SSE2
+    __m128d acc = _mm_set1_pd(result);
+    for (; i + 2 <= n; i += 2) {
+        acc = _mm_max_pd(acc, _mm_loadu_pd(array + i));
+    }
+    result = functional_hmax_pd(acc);
+#endif
+    for (; i < n; ++i) {
+        result = array[i] > result ? array[i] : result;
+    }
+    return result;
+}
+
+/**
+ * Fills <out> with each element of <array> that is greater than <pivot>, preserving order.
+ * Returns the new size of <out>. <out> must hold <n> elements and can be NULL.
+ */
+static inline size_t filter_greater_double(size_t n, const double *array, double pivot, double *out) {
+    assert(array != NULL || n == 0);
+    size_t i = 0;
+    size_t count = 0;
+    if (out == NULL) {
+        for (; i < n; ++i) {
+            count += array[i] > pivot ? 1 : 0;
+        }
+        return count;
+    }
+#if FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_AVX512
+    const __m512d p = _mm512_set1_pd(pivot);
+    for (; i + 8 <= n; i += 8) {
+        const __m512d v = _mm512_loadu_pd(array + i);
+        const __mmask8 mask = _mm512_cmp_pd_mask(v, p, _CMP_GT_OQ);
+        _mm512_mask_compressstoreu_pd(out + count, mask, v);
+        count += functional_popcount4(mask) + functional_popcount4(mask >> 4);
+    }
+#elif FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_SSSE3
+    const __m128d p = _mm_set1_pd(pivot);
+    for (; i + 2 <= n; i += 2) {
+        const __m128d v = _mm_loadu_pd(array + i);
+        count += functional_compact_epi64(_mm_castpd_si128(v), _mm_movemask_pd(_mm_cmpgt_pd(v, p)), out + count);
+    }
+#endif
+    for (; i < n; ++i) {
+        out[count] = array[i];
+        count += array[i] > pivot ? 1 : 0;
+    }
+    return count;
+}
+
+/**
+ * Fills <out> with each element of <array> that is less than <pivot>, preserving order.
+ * Returns the new size of <out>. <out> must hold <n> elements and can be NULL.
+ */
+static inline size_t filter_less_double(size_t n, const double *array, double pivot, double *out) {
+    assert(array != NULL || n == 0);
+    size_t i = 0;
+    size_t count = 0;
+    if (out == NULL) {
+        for (; i < n; ++i) {
+            count += array[i] < pivot ? 1 : 0;
+        }
+        return count;
+    }
+#if FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_AVX512
+    const __m512d p = _mm512_set1_pd(pivot);
+    for (; i + 8 <= n; i += 8) {
+        const __m512d v = _mm512_loadu_pd(array + i);
+        const __mmask8 mask = _mm512_cmp_pd_mask(v, p, _CMP_LT_OQ);
+        _mm512_mask_compressstoreu_pd(out + count, mask, v);
+        count += functional_popcount4(mask) + functional_popcount4(mask >> 4);
+    }
+#elif FUNCTIONAL_SIMD >= FUNCTIONAL_SIMD_SSSE3
+    const __m128d p = _mm_set1_pd(pivot);
+    for (; i + 2 <= n; i += 2) {
+        const __m128d v = _mm_loadu_pd(array + i);
+        count += functional_compact_epi64(_mm_castpd_si128(v), _mm_movemask_pd(_mm_cmplt_pd(v, p)), out + count);
+    }
+#endif
+    for (; i < n; ++i) {
+        out[count] = array[i];
+        count += array[i] < pivot ? 1 : 0;
+    }
+    return count;
+}
+
+#endif // FUNCTIONAL_SIMD_H
@@ -0,0 +1,303 @@
+// .c
+// SIMD Higher-Order Function Kernels Benchmark
+// by Kyle Furey
+
+// Compares the kernels of functional_simd.h to the map_, filter_, and reduce_ functions of functional.h.
+// Build with optimizations and the target's instruction set, such as: cc -O2 -march=native functional_simd_benchmark.c
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "functional.h"
+#include "functional_simd.h"
+
+/** The number of elements of each benchmarked array. */
+#define BENCHMARK_COUNT (1 << 20)
+
+/** The number of times each function is run over the array. */
+#define BENCHMARK_RUNS 64
+
+/** The pivot each filter compares against. */
+#define BENCHMARK_PIVOT 0
+
+/** The number of elements passed to each function, read at run time so calls are not specialized for one size. */
+static volatile size_t benchmark_count = BENCHMARK_COUNT;
+
+/** Stores the results of each run so they are not optimized away. */
+static volatile double benchmark_sink;
+
+
+// FUNCTIONS
+
+DECLARE_FUNCTIONAL_NAMED(int32_t, int32)
+DECLARE_FUNCTIONAL_NAMED(float, float)
+DECLARE_FUNCTIONAL_NAMED(double, double)
+
+/** Returns the sum of <acc> and <elem>, wrapping on overflow. */
+static inline int32_t add_int32(int32_t acc, int32_t elem) {
+    return (int32_t)((uint32_t)acc + (uint32_t)elem);
+}
+
+/** Returns the smaller of <acc> and <elem>. */
+static inline int32_t min2_int32(int32_t acc, int32_t elem) {
+    return elem < acc ? elem : acc;
+}
+
+/** Returns the larger of <acc> and <elem>. */
+static inline int32_t max2_int32(int32_t acc, int32_t elem) {
+    return elem > acc ? elem : acc;
+}
+
+/** Returns whether <elem> is greater than the pivot. */
+static inline bool greater_int32(int32_t elem) {
+    return elem > BENCHMARK_PIVOT;
+}
+
+/** Returns whether <elem> is less than the pivot. */
+static inline bool less_int32(int32_t elem) {
+    return elem < BENCHMARK_PIVOT;
+}
+
+/** Returns twice <elem>. */
+static inline int32_t double_int32(int32_t elem) {
+    return (int32_t)((uint32_t)elem * 2u);
+}
+
+/** Returns the sum of <acc> and <elem>. */
+static inline float add_float(float acc, float elem) {
+    return acc + elem;
+}
+
+/** Returns the smaller of <acc> and <elem>. */
+static inline float min2_float(float acc, float elem) {
+    return elem < acc ? elem : acc;
+}
+
+/** Returns the larger of <acc> and <elem>. */
+static inline float max2_float(float acc, float elem) {
+    return elem > acc ? elem : acc;
+}
+
+/** Returns whether <elem> is greater than the pivot. */
+static inline bool greater_float(float elem) {
+    return elem > BENCHMARK_PIVOT;
+}
+
+/** Returns whether <elem> is less than the pivot. */
+static inline bool less_float(float elem) {
+    return elem < BENCHMARK_PIVOT;
+}
+
+/** Returns the sum of <acc> and <elem>. */
+static inline double add_double(double acc, double elem) {
+    return acc + elem;
+}
+
+/** Returns the smaller of <acc> and <elem>. */
+static inline double min2_double(double acc, double elem) {
+    return elem < acc ? elem : acc;
+}
+
+/** Returns the larger of <acc> and <elem>. */
+static inline double max2_double(double acc, double elem) {
+    return elem > acc ? elem : acc;
+}
+
+/** Returns whether <elem> is greater than the pivot. */
+static inline bool greater_double(double elem) {
+    return elem > BENCHMARK_PIVOT;
+}
+
+/** Returns whether <elem> is less than the pivot. */
+static inline bool less_double(double elem) {
+    return elem < BENCHMARK_PIVOT;
+}
+
+DECLARE_MAP_INLINE_NAMED(int32_t, map_double_int32_inline, double_int32)
+DECLARE_REDUCE_INLINE_NAMED(int32_t, sum_int32_inline, add_int32)
+DECLARE_REDUCE_INLINE_NAMED(int32_t, min_int32_inline, min2_int32)
+DECLARE_FILTER_INLINE_NAMED(int32_t, filter_greater_int32_inline, greater_int32)
+DECLARE_REDUCE_INLINE_NAMED(float, sum_float_inline, add_float)
+DECLARE_FILTER_INLINE_NAMED(float, filter_greater_float_inline, greater_float)
+DECLARE_REDUCE_INLINE_NAMED(double, sum_double_inline, add_double)
+DECLARE_FILTER_INLINE_NAMED(double, filter_greater_double_inline, greater_double)
+
+
+// VERIFICATION
+
+/** Returns whether the <count> elements of <size> bytes in <out> equal the <expected_count> elements in <expected>. */
+static bool benchmark_same(size_t count, const void *out, size_t expected_count, const void *expected, size_t size) {
+    return count == expected_count && memcmp(out, expected, count * size) == 0;
+}
+
+/** Returns whether <sum> is within <epsilon> of <expected>, relative to <magnitude>, the sum of the magnitudes of the elements. */
+static bool benchmark_close(double sum, double expected, double magnitude, double epsilon) {
+    return fabs(sum - expected) <= epsilon * magnitude;
+}
+
+/** Returns the sum of the floats of <array> in double precision and stores the sum of their magnitudes in <magnitude>. */
+static double benchmark_exact_sum_float(size_t n, const float *array, double *magnitude) {
+    double sum = 0.0;
+    *magnitude = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += array[i];
+        *magnitude += fabs(array[i]);
+    }
+    return sum;
+}
+
+/** Returns the sum of the doubles of <array> and stores the sum of their magnitudes in <magnitude>. */
+static double benchmark_exact_sum_double(size_t n, const double *array, double *magnitude) {
+    double sum = 0.0;
+    *magnitude = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += array[i];
+        *magnitude += fabs(array[i]);
+    }
+    return sum;
+}
+
+/**
+ * Returns whether every kernel of functional_simd.h matches reduce_ and filter_ of functional.h over the given arrays.<br/>
+ * Integer results and filtered elements must match exactly. Float sums are reassociated by the kernels, so they must only match within rounding.
+ */
+static bool benchmark_verify(size_t n, const int32_t *ints, const float *floats, const double *doubles,
+                             int32_t *int_out, int32_t *int_expected, float *float_out, float *float_expected,
+                             double *double_out, double *double_expected) {
+    double float_magnitude;
+    double double_magnitude;
+    const double float_sum = benchmark_exact_sum_float(n, floats, &float_magnitude);
+    const double double_sum = benchmark_exact_sum_double(n, doubles, &double_magnitude);
+    return sum_int32(n, ints) == reduce_int32(n, ints, add_int32, 0) &&
+           min_int32(n, ints) == reduce_int32(n, ints, min2_int32, INT32_MAX) &&
+           max_int32(n, ints) == reduce_int32(n, ints, max2_int32, INT32_MIN) &&
+           benchmark_same(filter_greater_int32(n, ints, BENCHMARK_PIVOT, int_out), int_out,
+                          filter_int32(n, ints, greater_int32, int_expected), int_expected, sizeof(int32_t)) &&
+           benchmark_same(filter_less_int32(n, ints, BENCHMARK_PIVOT, int_out), int_out,
+                          filter_int32(n, ints, less_int32, int_expected), int_expected, sizeof(int32_t)) &&
+           benchmark_close(sum_float(n, floats), float_sum, float_magnitude, 1e-6) &&
+           min_float(n, floats) == reduce_float(n, floats, min2_float, INFINITY) &&
+           max_float(n, floats) == reduce_float(n, floats, max2_float, -INFINITY) &&
+           benchmark_same(filter_greater_float(n, floats, BENCHMARK_PIVOT, float_out), float_out,
+                          filter_float(n, floats, greater_float, float_expected), float_expected, sizeof(float)) &&
+           benchmark_same(filter_less_float(n, floats, BENCHMARK_PIVOT, float_out), float_out,
+                          filter_float(n, floats, less_float, float_expected), float_expected, sizeof(float)) &&
+           benchmark_close(sum_double(n, doubles), double_sum, double_magnitude, 1e-12) &&
+           min_double(n, doubles) == reduce_double(n, doubles, min2_double, INFINITY) &&
+           max_double(n, doubles) == reduce_double(n, doubles, max2_double, -INFINITY) &&
+           benchmark_same(filter_greater_double(n, doubles, BENCHMARK_PIVOT, double_out), double_out,
+                          filter_double(n, doubles, greater_double, double_expected), double_expected, sizeof(double)) &&
+           benchmark_same(filter_less_double(n, doubles, BENCHMARK_PIVOT, double_out), double_out,
+                          filter_double(n, doubles, less_double, double_expected), double_expected, sizeof(double));
+}
+
+
+// BENCHMARK
+
+/** Returns the current time in seconds. */
+static double benchmark_now(void) {
+    return (double)clock() / CLOCKS_PER_SEC;
+}
+
+/** Prints the nanoseconds per element of a benchmark that started at <start>. */
+static void benchmark_report(const char *name, double start) {
+    double elapsed = benchmark_now() - start;
+    printf("%-36s %8.3f ns/element\n", name, elapsed * 1e9 / ((double)BENCHMARK_COUNT * BENCHMARK_RUNS));
+}
+
+/** Runs <expression> BENCHMARK_RUNS times, adds each result to the sink, and reports its speed under <name>. */
+#define BENCHMARK(name, expression)\
+    do {\
+        double start = benchmark_now();\
+        for (int run = 0; run < BENCHMARK_RUNS; ++run) {\
+            benchmark_sink = benchmark_sink + (double)(expression);\
+        }\
+        benchmark_report(name, start);\
+    } while (0)
+
+/** Entry point of the program. */
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+    size_t n = benchmark_count;
+    int32_t *ints = malloc(BENCHMARK_COUNT * sizeof(int32_t));
+    int32_t *int_out = malloc(BENCHMARK_COUNT * sizeof(int32_t));
+    float *floats = malloc(BENCHMARK_COUNT * sizeof(float));
+    float *float_out = malloc(BENCHMARK_COUNT * sizeof(float));
+    double *doubles = malloc(BENCHMARK_COUNT * sizeof(double));
+    double *double_out = malloc(BENCHMARK_COUNT * sizeof(double));
+    int32_t *int_expected = malloc(BENCHMARK_COUNT * sizeof(int32_t));
+    float *float_expected = malloc(BENCHMARK_COUNT * sizeof(float));
+    double *double_expected = malloc(BENCHMARK_COUNT * sizeof(double));
+    if (ints == NULL || int_out == NULL || floats == NULL || float_out == NULL || doubles == NULL || double_out == NULL ||
+        int_expected == NULL || float_expected == NULL || double_expected == NULL) {
+        printf("ERROR: Out of memory!\n");
+        return 1;
+    }
+    srand(1);
+    for (size_t i = 0; i < BENCHMARK_COUNT; ++i) {
+        ints[i] = rand() % 2001 - 1000;
+        floats[i] = (float)ints[i] / 7.0f;
+        doubles[i] = (double)ints[i] / 7.0;
+    }
+
+    printf("functional_simd.h level %d, %d elements, %d runs\n\n", FUNCTIONAL_SIMD, BENCHMARK_COUNT, BENCHMARK_RUNS);
+
+    if (!benchmark_verify(n, ints, floats, doubles, int_out, int_expected, float_out, float_expected, double_out, double_expected)) {
+        printf("ERROR: The SIMD kernels do not match reduce_ and filter_!\n");
+        return 1;
+    }
+
+    BENCHMARK("map_int32 (function pointer)", map_int32(n, ints, double_int32, int_out)[0]);
+    BENCHMARK("map_int32 (inline)", map_double_int32_inline(n, ints, int_out)[0]);
+    printf("\n");
+
+    BENCHMARK("reduce_int32 sum (function pointer)", reduce_int32(n, ints, add_int32, 0));
+    BENCHMARK("reduce_int32 sum (inline)", sum_int32_inline(n, ints, 0));
+    BENCHMARK("sum_int32 (SIMD)", sum_int32(n, ints));
+    printf("\n");
+
+    BENCHMARK("reduce_int32 min (function pointer)", reduce_int32(n, ints, min2_int32, INT32_MAX));
+    BENCHMARK("reduce_int32 min (inline)", min_int32_inline(n, ints, INT32_MAX));
+    BENCHMARK("min_int32 (SIMD)", min_int32(n, ints));
+    printf("\n");
+
+    BENCHMARK("filter_int32 (function pointer)", filter_int32(n, ints, greater_int32, int_out));
+    BENCHMARK("filter_int32 (inline)", filter_greater_int32_inline(n, ints, int_out));
+    BENCHMARK("filter_greater_int32 (SIMD)", filter_greater_int32(n, ints, BENCHMARK_PIVOT, int_out));
+    printf("\n");
+
+    BENCHMARK("reduce_float sum (function pointer)", reduce_float(n, floats, add_float, 0.0f));
+    BENCHMARK("reduce_float sum (inline)", sum_float_inline(n, floats, 0.0f));
+    BENCHMARK("sum_float (SIMD)", sum_float(n, floats));
+    printf("\n");
+
+    BENCHMARK("filter_float (function pointer)", filter_float(n, floats, greater_float, float_out));
+    BENCHMARK("filter_float (inline)", filter_greater_float_inline(n, floats, float_out));
+    BENCHMARK("filter_greater_float (SIMD)", filter_greater_float(n, floats, BENCHMARK_PIVOT, float_out));
+    printf("\n");
+
+    BENCHMARK("reduce_double sum (function pointer)", reduce_double(n, doubles, add_double, 0.0));
+    BENCHMARK("reduce_double sum (inline)", sum_double_inline(n, doubles, 0.0));
+    BENCHMARK("sum_double (SIMD)", sum_double(n, doubles));
+    printf("\n");
+
+    BENCHMARK("filter_double (function pointer)", filter_double(n, doubles, greater_double, double_out));
+    BENCHMARK("filter_double (inline)", filter_greater_double_inline(n, doubles, double_out));
+    BENCHMARK("filter_greater_double (SIMD)", filter_greater_double(n, doubles, BENCHMARK_PIVOT, double_out));
+
+    free(ints);
+    free(int_out);
+    free(floats);
+    free(float_out);
+    free(doubles);
+    free(double_out);
+    free(int_expected);
+    free(float_expected);
+    free(double_expected);
+    return 0;
+}
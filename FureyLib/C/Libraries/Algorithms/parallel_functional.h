@@ -0,0 +1,202 @@
+// .h
+// Parallel Higher-Order Function Library
+// by Kyle Furey
+
+#ifndef PARALLEL_FUNCTIONAL_H
+#define PARALLEL_FUNCTIONAL_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include "functional.h"
+#include "../../Data Types/Utilities/thread_pool/thread_pool.h"
+
+#ifndef FUNCTIONAL_PARALLEL_GRAIN
+// The number of elements in each chunk of a parallel higher-order function.
+#define FUNCTIONAL_PARALLEL_GRAIN 16384
+#endif
+
+/** Returns the number of chunks an array of <n> elements is split into. */
+static inline size_t functional_chunks(size_t n) {
+    return (n + FUNCTIONAL_PARALLEL_GRAIN - 1) / FUNCTIONAL_PARALLEL_GRAIN;
+}
+
+/** Sets <begin> and <end> to the element range of chunk <index> of an array of <n> elements. */
+static inline void functional_chunk(size_t n, size_t index, size_t *begin, size_t *end) {
+    *begin = index * FUNCTIONAL_PARALLEL_GRAIN;
+    *end = n - *begin < FUNCTIONAL_PARALLEL_GRAIN ? n : *begin + FUNCTIONAL_PARALLEL_GRAIN;
+}
+
+/**
+ * Declares named parallel higher-order functions for the given array type:
+ * pmap(), pfilter(), and preduce().
+ * Arrays are split into chunks of FUNCTIONAL_PARALLEL_GRAIN elements that run across <pool>.
+ * Chunks do not depend on the number of threads, so results are the same for any pool.
+ * A NULL <pool> runs every chunk on the calling thread.
+ * DECLARE_FUNCTIONAL_NAMED() must be declared for the same type and name first.
+ */
+#define DECLARE_PARALLEL_FUNCTIONAL_NAMED(T, typename)\
+\
+/** The arguments of a pmap() job. */\
+typedef struct {\
+    /** The number of elements in the array. */\
+    size_t n;\
+    /** The array being iterated. */\
+    const T *array;\
+    /** The function applied to each element. */\
+    T(*transform)(T elem);\
+    /** The array being filled. */\
+    T *out;\
+} pmap_##typename##_job;\
+\
+/** Runs one chunk of a pmap() job. */\
+static inline void pmap_##typename##_task(size_t index, void *ctx) {\
+    pmap_##typename##_job *job = (pmap_##typename##_job *)ctx;\
+    size_t begin, end;\
+    functional_chunk(job->n, index, &begin, &end);\
+    for (size_t i = begin; i < end; ++i) {\
+        job->out[i] = job->transform(job->array[i]);\
+    }\
+}\
+\
+/**\
+ * Iterates <array> across <pool> and fills <out> with each element returned by <transform>.\
+ * Returns <out>. <out> cannot be NULL.\
+ */\
+static inline T *pmap_##typename(thread_pool *pool, size_t n, const T *array, T(*transform)(T elem), T *out) {\
+    assert(array != NULL);\
+    assert(transform != NULL);\
+    assert(out != NULL);\
+    pmap_##typename##_job job = {n, array, transform, out};\
+    thread_pool_run(pool, functional_chunks(n), pmap_##typename##_task, &job);\
+    return out;\
+}\
+\
+/** The arguments of a pfilter() job. */\
+typedef struct {\
+    /** The number of elements in the array. */\
+    size_t n;\
+    /** The array being iterated. */\
+    const T *array;\
+    /** The function each kept element passes. */\
+    bool(*predicate)(T elem);\
+    /** The array being filled. */\
+    T *out;\
+    /** The number of kept elements in each chunk, then the offset of each chunk in <out>. */\
+    size_t *offsets;\
+} pfilter_##typename##_job;\
+\
+/** Counts the elements of one chunk of a pfilter() job that pass its predicate. */\
+static inline void pfilter_##typename##_count(size_t index, void *ctx) {\
+    pfilter_##typename##_job *job = (pfilter_##typename##_job *)ctx;\
+    size_t begin, end, count = 0;\
+    functional_chunk(job->n, index, &begin, &end);\
+    for (size_t i = begin; i < end; ++i) {\
+        if (job->predicate(job->array[i])) {\
+            ++count;\
+        }\
+    }\
+    job->offsets[index] = count;\
+}\
+\
+/** Writes the elements of one chunk of a pfilter() job that pass its predicate at the chunk's offset. */\
+static inline void pfilter_##typename##_write(size_t index, void *ctx) {\
+    pfilter_##typename##_job *job = (pfilter_##typename##_job *)ctx;\
+    size_t begin, end, count = job->offsets[index];\
+    functional_chunk(job->n, index, &begin, &end);\
+    for (size_t i = begin; i < end; ++i) {\
+        if (job->predicate(job->array[i])) {\
+            job->out[count++] = job->array[i];\
+        }\
+    }\
+}\
+\
+/**\
+ * Iterates <array> across <pool> and fills <out> with each elements that passes <predicate>, preserving order.\
+ * <predicate> is called twice per element (count, then write) and must not have side effects.\
+ * Returns the new size of <out>. <out> can be NULL.\
+ */\
+static inline size_t pfilter_##typename(thread_pool *pool, size_t n, const T *array, bool(*predicate)(T elem), T *out) {\
+    assert(array != NULL);\
+    assert(predicate != NULL);\
+    size_t chunks = functional_chunks(n);\
+    if (chunks <= 1) {\
+        return filter_##typename(n, array, predicate, out);\
+    }\
+    size_t *offsets = (size_t *)malloc(chunks * sizeof(size_t));\
+    if (offsets == NULL) {\
+        return filter_##typename(n, array, predicate, out);\
+    }\
+    pfilter_##typename##_job job = {n, array, predicate, out, offsets};\
+    thread_pool_run(pool, chunks, pfilter_##typename##_count, &job);\
+    size_t total = 0;\
+    for (size_t i = 0; i < chunks; ++i) {\
+        size_t count = offsets[i];\
+        offsets[i] = total;\
+        total += count;\
+    }\
+    if (out != NULL) {\
+        thread_pool_run(pool, chunks, pfilter_##typename##_write, &job);\
+    }\
+    free(offsets);\
+    return total;\
+}\
+\
+/** The arguments of a preduce() job. */\
+typedef struct {\
+    /** The number of elements in the array. */\
+    size_t n;\
+    /** The array being iterated. */\
+    const T *array;\
+    /** The function folding each element into the accumulator. */\
+    T(*accumulator)(T acc, T elem);\
+    /** The accumulated result of each chunk. */\
+    T *partials;\
+} preduce_##typename##_job;\
+\
+/** Reduces one chunk of a preduce() job into its partial accumulator. */\
+static inline void preduce_##typename##_task(size_t index, void *ctx) {\
+    preduce_##typename##_job *job = (preduce_##typename##_job *)ctx;\
+    size_t begin, end;\
+    functional_chunk(job->n, index, &begin, &end);\
+    T acc = job->array[begin];\
+    for (size_t i = begin + 1; i < end; ++i) {\
+        acc = job->accumulator(acc, job->array[i]);\
+    }\
+    job->partials[index] = acc;\
+}\
+\
+/**\
+ * Reduces each chunk of <array> across <pool>, then folds each chunk's result into <start> in order.\
+ * <accumulator> must be associative for the result to match reduce().\
+ * Returns the final value created by <accumulator>.\
+ */\
+static inline T preduce_##typename(thread_pool *pool, size_t n, const T *array, T(*accumulator)(T acc, T elem), T start) {\
+    assert(array != NULL);\
+    assert(accumulator != NULL);\
+    size_t chunks = functional_chunks(n);\
+    if (chunks <= 1) {\
+        return reduce_##typename(n, array, accumulator, start);\
+    }\
+    T *partials = (T *)malloc(chunks * sizeof(T));\
+    if (partials == NULL) {\
+        return reduce_##typename(n, array, accumulator, start);\
+    }\
+    preduce_##typename##_job job = {n, array, accumulator, partials};\
+    thread_pool_run(pool, chunks, preduce_##typename##_task, &job);\
+    for (size_t i = 0; i < chunks; ++i) {\
+        start = accumulator(start, partials[i]);\
+    }\
+    free(partials);\
+    return start;\
+}
+
+/**
+ * Declares parallel higher-order functions for the given array type:
+ * pmap(), pfilter(), and preduce().
+ * DECLARE_FUNCTIONAL() must be declared for the same type first.
+ */
+#define DECLARE_PARALLEL_FUNCTIONAL(T) DECLARE_PARALLEL_FUNCTIONAL_NAMED(T, T)
+
+#endif // PARALLEL_FUNCTIONAL_H